@@ -0,0 +1,213 @@
+/**
+ * Reception throughput benchmark of Freecanard.
+ *
+ * A set of producer tasks, one per core, feed single-frame heartbeat
+ * transfers from distinct remote nodes into one bus, and the time until the
+ * transfer callback has seen all of them is measured. Each producer stands
+ * in for the receive interrupt of an interface serviced by its core: it is
+ * pinned to the core and enters frames through
+ * freecanard_process_received_frame_from_ISR, so frames go through the
+ * ingestion queue of that core. The benchmark is run
+ * with an increasing number of producers, up to the number of cores of the
+ * kernel, to show how throughput scales with the number of cores ingesting
+ * frames.
+ *
+ * @note The FreeRTOS POSIX port executes a single task at a time, so it
+ * always behaves as a single core. Figures showing actual scaling require
+ * building the benchmark against the FreeRTOS SMP kernel.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "freecanard.h"
+
+#define BENCH_TRANSFERS_PER_PRODUCER 20000UL
+#define BENCH_PRODUCER_PRIORITY (tskIDLE_PRIORITY + 1)
+#define BENCH_PROCESSING_PRIORITY (tskIDLE_PRIORITY + 2)
+#define BENCH_CONTROL_PRIORITY (tskIDLE_PRIORITY + 3)
+#define BENCH_SUBJECT_ID 7509U
+
+// The ISR entry point never blocks, so producers keep at most this many
+// frames in flight to not overflow the ingestion queues
+#define BENCH_WINDOW (FREECANARD_DEFAULT_PROCESSING_TASK_QUEUE_SIZE / 2U)
+
+#define BENCH_MEMORY_POOL_SIZE 16384
+static uint8_t memory_pool[BENCH_MEMORY_POOL_SIZE] __attribute__((aligned(O1HEAP_ALIGNMENT)));
+static freecanard_cookie_t cookie;
+static CanardInstance bus;
+static CanardRxSubscription subscription;
+
+static volatile uint32_t transfers_received;
+static volatile uint32_t producer_transfers_received[FREECANARD_NUM_CORES];
+static TaskHandle_t control_task_handle;
+static uint32_t transfers_expected;
+
+static int8_t bench_send(const CanardFrame *const frame, const bool can_fd)
+{
+    (void)frame;
+    (void)can_fd;
+    return 0;
+}
+
+static void bench_on_transfer_received(CanardInstance *ins, const CanardTransfer *const transfer)
+{
+    (void)ins;
+    producer_transfers_received[transfer->remote_node_id - 1U]++;
+    if (++transfers_received == transfers_expected)
+    {
+        xTaskNotifyGive(control_task_handle);
+    }
+}
+
+static double bench_now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench_producer_task(void *parameters)
+{
+    const uint8_t producer = (uint8_t)(uintptr_t)parameters;
+    uint8_t payload[8] = {0xb8, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x9d, 0x00};
+
+    // Message, nominal priority, each producer simulates a distinct remote node
+    CanardFrame frame;
+    frame.extended_can_id = (4UL << 26U) | (3UL << 21U) | ((uint32_t)BENCH_SUBJECT_ID << 8U) | (uint32_t)(producer + 1U);
+    frame.payload_size = sizeof(payload);
+    frame.payload = payload;
+
+    for (uint32_t i = 0; i < BENCH_TRANSFERS_PER_PRODUCER; i++)
+    {
+        while (i - producer_transfers_received[producer] >= BENCH_WINDOW)
+        {
+            taskYIELD();
+        }
+
+        // Single-frame transfer: start, end and toggle set
+        payload[7] = (uint8_t)(0xE0U | (i & CANARD_TRANSFER_ID_MAX));
+        frame.timestamp_usec = (CanardMicrosecond)i * 1000U;
+        freecanard_process_received_frame_from_ISR(&bus, &frame, 0);
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void bench_control_task(void *parameters)
+{
+    (void)parameters;
+
+    for (UBaseType_t producers = 1; producers <= FREECANARD_NUM_CORES; producers++)
+    {
+        transfers_received = 0;
+        transfers_expected = producers * BENCH_TRANSFERS_PER_PRODUCER;
+        for (UBaseType_t i = 0; i < FREECANARD_NUM_CORES; i++)
+        {
+            producer_transfers_received[i] = 0;
+        }
+
+        const double start = bench_now_sec();
+        for (UBaseType_t i = 0; i < producers; i++)
+        {
+#if (FREECANARD_NUM_CORES > 1) && (configUSE_CORE_AFFINITY == 1)
+            xTaskCreateAffinitySet(
+                bench_producer_task,
+                "BenchProducer",
+                configMINIMAL_STACK_SIZE,
+                (void *)(uintptr_t)i,
+                BENCH_PRODUCER_PRIORITY,
+                (UBaseType_t)1U << i,
+                NULL);
+#else
+            xTaskCreate(
+                bench_producer_task,
+                "BenchProducer",
+                configMINIMAL_STACK_SIZE,
+                (void *)(uintptr_t)i,
+                BENCH_PRODUCER_PRIORITY,
+                NULL);
+#endif
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const double elapsed = bench_now_sec() - start;
+
+        freecanard_stats_t stats;
+        freecanard_get_stats(&bus, &stats);
+        printf("producers: %lu, transfers: %lu, elapsed: %.3f s, throughput: %.0f transfers/s, pool hits: %lu\n",
+               (unsigned long)producers,
+               (unsigned long)transfers_expected,
+               elapsed,
+               (double)transfers_expected / elapsed,
+               (unsigned long)stats.rx_payload_pool_hits);
+        fflush(stdout);
+    }
+
+    vTaskEndScheduler();
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    if (!freecanard_init(
+            &bus,
+            &cookie,
+            1,
+            CANARD_MTU_CAN_CLASSIC,
+            memory_pool,
+            BENCH_MEMORY_POOL_SIZE,
+            BENCH_PROCESSING_PRIORITY,
+            FREECANARD_DEFAULT_PROCESSING_TASK_QUEUE_SIZE,
+            FREECANARD_DEFAULT_PROCESSING_TASK_STACK_SIZE,
+            bench_send,
+            bench_on_transfer_received))
+    {
+        printf("Unable to initialize the bus\n");
+        return 1;
+    }
+
+    // Pin the processing task to the first core, leaving the others to the
+    // producers. No-op on single core kernels.
+    freecanard_set_core_affinity(&bus, 1U, 0U);
+
+    freecanard_subscribe(
+        &bus,
+        CanardTransferKindMessage,
+        BENCH_SUBJECT_ID,
+        8,
+        CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
+        &subscription);
+
+    xTaskCreate(bench_control_task, "BenchControl", configMINIMAL_STACK_SIZE, NULL, BENCH_CONTROL_PRIORITY, &control_task_handle);
+
+    vTaskStartScheduler();
+    return 0;
+}
+
+/* configSUPPORT_STATIC_ALLOCATION is set to 1, so the application must
+provide the memory used by the Idle and Timer tasks. */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
@@ -68,6 +68,7 @@
 /* Local includes. */
 #include "console.h"
 #include "uavcan.h"
+#include "freecanard_scheduler.h"
 
 #include "uavcan/node/Heartbeat_1_0.h"
 
@@ -94,46 +95,27 @@ static BaseType_t xTraceRunning = pdTRUE;
 
 /*-----------------------------------------------------------*/
 
-#define TASK_1_PRIORITY (tskIDLE_PRIORITY + 1)
-#define TASK_1_FREQUENCY_MS pdMS_TO_TICKS(1000UL)
-static void task_1(void *pvParameters)
-{
-	TickType_t xNextWakeTime;
-	const TickType_t xBlockTime = TASK_1_FREQUENCY_MS;
+#define SCHEDULER_PRIORITY (tskIDLE_PRIORITY + 1)
+#define HEARTBEAT_PERIOD pdMS_TO_TICKS(1000UL)
+static freecanard_scheduler_t scheduler;
+static freecanard_publication_t heartbeat_publication;
 
+static int8_t serialize_heartbeat(freecanard_publication_t *publication, uint8_t *const buffer, size_t *const inout_size)
+{
 	/* Prevent the compiler warning about the unused parameter. */
-	(void)pvParameters;
-
-	/* Initialise xNextWakeTime - this only needs to be done once. */
-	xNextWakeTime = xTaskGetTickCount();
+	(void)publication;
 
 	uavcan_node_Heartbeat_1_0 heartbeat;
 	heartbeat.health.value = uavcan_node_Health_1_0_NOMINAL;
 	heartbeat.mode.value = uavcan_node_Mode_1_0_OPERATIONAL;
-	uint8_t buffer[uavcan_node_Heartbeat_1_0_SERIALIZATION_BUFFER_SIZE_BYTES_];
-	size_t buffer_size = uavcan_node_Heartbeat_1_0_SERIALIZATION_BUFFER_SIZE_BYTES_;
-	uint8_t heartbeat_transfer_id = 0;
+	heartbeat.uptime = xTaskGetTickCount();
 
-	for (;;)
+	int8_t res = uavcan_node_Heartbeat_1_0_serialize_(&heartbeat, buffer, inout_size);
+	if (res < 0)
 	{
-		vTaskDelayUntil(&xNextWakeTime, xBlockTime);
-
-		heartbeat.uptime = xTaskGetTickCount();
-		int8_t res = uavcan_node_Heartbeat_1_0_serialize_(&heartbeat, buffer, &buffer_size);
-		if (res < 0)
-		{
-			printf("Unable to serialize heartbeat message, return code: %d\n", res);
-			continue;
-		}
-
-		freecanard_transmit_message(
-			&bus_0,
-			uavcan_node_Heartbeat_1_0_FIXED_PORT_ID_,
-			CanardPriorityNominal,
-			buffer,
-			buffer_size,
-			&heartbeat_transfer_id);
+		printf("Unable to serialize heartbeat message, return code: %d\n", res);
 	}
+	return res;
 }
 
 #define TASK_2_PRIORITY (tskIDLE_PRIORITY + 2)
@@ -179,7 +161,24 @@ int main(void)
 	console_init();
 	uavcan_init();
 
-	xTaskCreate(task_1, "task 1", configMINIMAL_STACK_SIZE, NULL, TASK_1_PRIORITY, NULL);
+	if (!freecanard_scheduler_init(&scheduler, SCHEDULER_PRIORITY, configMINIMAL_STACK_SIZE))
+	{
+		printf("Unable to initialize the publication scheduler\n");
+		return 1;
+	}
+	if (!freecanard_scheduler_add(
+			&scheduler,
+			&heartbeat_publication,
+			&bus_0,
+			uavcan_node_Heartbeat_1_0_FIXED_PORT_ID_,
+			CanardPriorityNominal,
+			HEARTBEAT_PERIOD,
+			FREECANARD_PHASE_AUTO,
+			serialize_heartbeat))
+	{
+		printf("Unable to schedule the heartbeat publication\n");
+		return 1;
+	}
 	xTaskCreate(task_2, "task 2", configMINIMAL_STACK_SIZE, NULL, TASK_2_PRIORITY, NULL);
 
 	vTaskStartScheduler();
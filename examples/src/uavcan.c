@@ -3,8 +3,11 @@
 #include "console.h"
 #include <stdio.h>
 
+#include "uavcan/node/GetInfo_1_0.h"
 #include "uavcan/node/Heartbeat_1_0.h"
 
+#include <string.h>
+
 #define NODE_ID 1
 
 #define MEMORY_POOL_BUS_0_SIZE 8196
@@ -12,9 +15,15 @@ static uint8_t memory_pool_bus_0[MEMORY_POOL_BUS_0_SIZE] __attribute__ ((aligned
 static freecanard_cookie_t cookie_0;
 
 CanardRxSubscription heartbeat_subscription;
+CanardRxSubscription get_info_subscription;
+
+static uavcan_node_GetInfo_Response_1_0 get_info;
+static uint8_t get_info_buffer[uavcan_node_GetInfo_Response_1_0_SERIALIZATION_BUFFER_SIZE_BYTES_];
+static freecanard_payload_cache_t get_info_cache;
 
 static int8_t send(const freecanard_frame_t *const frame, const bool can_fd);
 static void uavcan_on_transfer_received(CanardInstance *ins, const CanardTransfer *const transfer);
+static int8_t serialize_get_info(const void *const source, uint8_t *const buffer, size_t *const inout_size);
 
 void uavcan_init()
 {
@@ -27,6 +36,7 @@ void uavcan_init()
         MEMORY_POOL_BUS_0_SIZE,
         tskIDLE_PRIORITY,
         FREECANARD_DEFAULT_PROCESSING_TASK_QUEUE_SIZE,
+        FREECANARD_DEFAULT_PROCESSING_TASK_STACK_SIZE,
         send,
         uavcan_on_transfer_received);
 
@@ -37,6 +47,34 @@ void uavcan_init()
         uavcan_node_Heartbeat_1_0_EXTENT_BYTES_,
         CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
         &heartbeat_subscription);
+
+    // The node info never changes, serialize it once for all requests
+    uavcan_node_GetInfo_Response_1_0_initialize_(&get_info);
+    get_info.protocol_version.major = 1;
+    get_info.name.count = strlen("freecanard.demo");
+    memcpy(get_info.name.elements, "freecanard.demo", get_info.name.count);
+    freecanard_payload_cache_init(
+        &get_info_cache,
+        &get_info,
+        serialize_get_info,
+        get_info_buffer,
+        sizeof(get_info_buffer));
+
+    freecanard_subscribe(
+        &bus_0,
+        CanardTransferKindRequest,
+        uavcan_node_GetInfo_1_0_FIXED_PORT_ID_,
+        uavcan_node_GetInfo_Request_1_0_EXTENT_BYTES_,
+        CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
+        &get_info_subscription);
+}
+
+static int8_t serialize_get_info(const void *const source, uint8_t *const buffer, size_t *const inout_size)
+{
+    return uavcan_node_GetInfo_Response_1_0_serialize_(
+        (const uavcan_node_GetInfo_Response_1_0 *)source,
+        buffer,
+        inout_size);
 }
 
 static int8_t send(const freecanard_frame_t *const frame, const bool can_fd)
@@ -72,4 +110,9 @@ static void uavcan_on_transfer_received(CanardInstance *ins, const CanardTransfe
         }
         }
     }
+    else if (transfer->transfer_kind == CanardTransferKindRequest &&
+             transfer->port_id == uavcan_node_GetInfo_1_0_FIXED_PORT_ID_)
+    {
+        freecanard_respond_cached(ins, &get_info_cache, transfer);
+    }
 }
\ No newline at end of file
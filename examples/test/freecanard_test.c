@@ -0,0 +1,609 @@
+/**
+ * Regression tests of Freecanard, run on the FreeRTOS POSIX port against
+ * libcanard.
+ *
+ * The frames are entered as a driver would, and the transfers are reassembled
+ * by canardRxAccept on the processing task. Service requests handed to the
+ * driver are answered, when a test asks for it, as the remote server would.
+ * The process exits with a non-zero status if any check fails.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "freecanard.h"
+
+#define TEST_PROCESSING_PRIORITY (tskIDLE_PRIORITY + 2)
+#define TEST_CONTROL_PRIORITY (tskIDLE_PRIORITY + 1)
+#define TEST_TIMEOUT pdMS_TO_TICKS(1000UL)
+
+#define TEST_PROVIDED_SUBJECT_ID 1000U
+#define TEST_POOL_SUBJECT_ID 1001U
+#define TEST_STREAM_SUBJECT_ID 1002U
+#define TEST_SERVICE_ID 100U
+#define TEST_CALL_TIMEOUT pdMS_TO_TICKS(50UL)
+#define TEST_PROVIDED_EXTENT 16U
+#define TEST_REMOTE_NODE_ID 42U
+
+#define TEST_CHECK(condition)                                                    \
+    do                                                                           \
+    {                                                                            \
+        if (!(condition))                                                        \
+        {                                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            test_failures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define TEST_MEMORY_POOL_SIZE 16384
+static uint8_t memory_pool[TEST_MEMORY_POOL_SIZE] __attribute__((aligned(O1HEAP_ALIGNMENT)));
+static freecanard_cookie_t cookie;
+static CanardInstance bus;
+static CanardRxSubscription provided_subscription;
+static CanardRxSubscription pool_subscription;
+static CanardRxSubscription response_subscription;
+
+static TaskHandle_t control_task_handle;
+static uint32_t test_failures;
+
+/**
+ * Provider lending a single buffer, and recording how it is handed back.
+ */
+static uint8_t provided_buffer[TEST_PROVIDED_EXTENT];
+static uint32_t provider_acquired;
+static uint32_t provider_released;
+static uint32_t provider_released_foreign;
+static freecanard_buffer_provider_t provider;
+
+static uint32_t provided_transfers;
+static uint32_t pool_transfers;
+static uint8_t provided_payload[TEST_PROVIDED_EXTENT];
+static size_t provided_payload_size;
+static bool provided_payload_in_buffer;
+
+/**
+ * Streaming subscription, and the chunks and events it received.
+ */
+#define TEST_STREAM_CAPACITY 64U
+static freecanard_stream_t stream;
+static uint8_t stream_payload[TEST_STREAM_CAPACITY];
+static size_t stream_size;
+static size_t stream_end_size;
+static uint32_t stream_ends;
+static uint32_t stream_aborts;
+static bool stream_out_of_order;
+
+/**
+ * Requests sent by the node, answered right away by the remote server if
+ * requested, and responses no call consumed.
+ */
+static bool server_responds;
+static uint32_t requests_sent;
+static CanardTransferID request_transfer_id;
+static uint32_t unmatched_responses;
+static CanardTransferID unmatched_transfer_id;
+
+static freecanard_call_t async_call;
+static uint32_t async_completions;
+static bool async_response_received;
+static size_t async_response_size;
+
+static void *test_provider_acquire(freecanard_buffer_provider_t *p, const size_t size)
+{
+    (void)p;
+    if (size > sizeof(provided_buffer))
+    {
+        return NULL;
+    }
+    provider_acquired++;
+    return provided_buffer;
+}
+
+static void test_provider_release(freecanard_buffer_provider_t *p, void *buffer)
+{
+    (void)p;
+    if (buffer != provided_buffer)
+    {
+        provider_released_foreign++;
+        return;
+    }
+    provider_released++;
+}
+
+static void test_enter_response(const CanardTransferID transfer_id, const uint8_t *const data, const size_t size);
+
+static int8_t test_send(const CanardFrame *const frame, const bool can_fd)
+{
+    (void)can_fd;
+
+    // Service request to the remote server
+    const uint32_t can_id = frame->extended_can_id;
+    if ((can_id & (1UL << 25U)) != 0U && (can_id & (1UL << 24U)) != 0U &&
+        ((can_id >> 14U) & CANARD_SERVICE_ID_MAX) == TEST_SERVICE_ID &&
+        ((can_id >> 7U) & CANARD_NODE_ID_MAX) == TEST_REMOTE_NODE_ID)
+    {
+        const uint8_t *const payload = (const uint8_t *)frame->payload;
+        requests_sent++;
+        request_transfer_id = (CanardTransferID)(payload[frame->payload_size - 1U] & CANARD_TRANSFER_ID_MAX);
+        if (server_responds)
+        {
+            static const uint8_t response[2] = {0x22, 0x33};
+            test_enter_response(request_transfer_id, response, sizeof(response));
+        }
+    }
+    return 0;
+}
+
+static void test_on_transfer_received(CanardInstance *ins, const CanardTransfer *const transfer)
+{
+    (void)ins;
+    if (transfer->port_id == TEST_PROVIDED_SUBJECT_ID)
+    {
+        provided_transfers++;
+        provided_payload_in_buffer = transfer->payload == provided_buffer;
+        provided_payload_size = transfer->payload_size;
+        memcpy(provided_payload, transfer->payload, transfer->payload_size);
+    }
+    else if (transfer->port_id == TEST_POOL_SUBJECT_ID)
+    {
+        pool_transfers++;
+    }
+    else if (transfer->transfer_kind == CanardTransferKindResponse && transfer->port_id == TEST_SERVICE_ID)
+    {
+        unmatched_responses++;
+        unmatched_transfer_id = transfer->transfer_id;
+    }
+    xTaskNotifyGive(control_task_handle);
+}
+
+static void test_on_stream(
+    CanardInstance *ins,
+    freecanard_stream_t *s,
+    const freecanard_stream_event_t event,
+    const CanardTransfer *const chunk,
+    const size_t offset)
+{
+    (void)ins;
+    (void)s;
+    switch (event)
+    {
+    case FREECANARD_STREAM_CHUNK:
+        if (offset != stream_size || stream_size + chunk->payload_size > sizeof(stream_payload))
+        {
+            stream_out_of_order = true;
+            return;
+        }
+        memcpy(&stream_payload[stream_size], chunk->payload, chunk->payload_size);
+        stream_size += chunk->payload_size;
+        return;
+    case FREECANARD_STREAM_END:
+        stream_ends++;
+        stream_end_size = offset;
+        break;
+    case FREECANARD_STREAM_ABORT:
+        stream_aborts++;
+        break;
+    }
+    xTaskNotifyGive(control_task_handle);
+}
+
+/**
+ * CRC-16/CCITT-FALSE, closing multi-frame transfers.
+ */
+static uint16_t test_crc(const uint8_t *const data, const size_t size)
+{
+    uint16_t crc = 0xFFFFU;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)((uint16_t)data[i] << 8U);
+        for (uint8_t bit = 0; bit < 8U; bit++)
+        {
+            crc = (crc & 0x8000U) != 0 ? (uint16_t)((crc << 1U) ^ 0x1021U) : (uint16_t)(crc << 1U);
+        }
+    }
+    return crc;
+}
+
+static void test_enter_frame(
+    const CanardPortID subject_id,
+    const uint8_t *const data,
+    const size_t size,
+    const bool start,
+    const bool end,
+    const bool toggle,
+    const uint8_t transfer_id)
+{
+    uint8_t payload[CANARD_MTU_CAN_CLASSIC];
+    memcpy(payload, data, size);
+    payload[size] = (uint8_t)((start ? 0x80U : 0U) | (end ? 0x40U : 0U) | (toggle ? 0x20U : 0U) | transfer_id);
+
+    // Message, nominal priority
+    CanardFrame frame;
+    frame.timestamp_usec = 0;
+    frame.extended_can_id = (4UL << 26U) | (3UL << 21U) | ((uint32_t)subject_id << 8U) | TEST_REMOTE_NODE_ID;
+    frame.payload_size = size + 1U;
+    frame.payload = payload;
+    freecanard_process_received_frame(&bus, &frame, 0, portMAX_DELAY);
+}
+
+/**
+ * Enter a single-frame response of the remote server to the node.
+ */
+static void test_enter_response(const CanardTransferID transfer_id, const uint8_t *const data, const size_t size)
+{
+    uint8_t payload[CANARD_MTU_CAN_CLASSIC];
+    memcpy(payload, data, size);
+    payload[size] = (uint8_t)(0xE0U | transfer_id);
+
+    // Response, nominal priority
+    CanardFrame frame;
+    frame.timestamp_usec = 0;
+    frame.extended_can_id = (4UL << 26U) | (1UL << 25U) | ((uint32_t)TEST_SERVICE_ID << 14U) |
+                            ((uint32_t)bus.node_id << 7U) | TEST_REMOTE_NODE_ID;
+    frame.payload_size = size + 1U;
+    frame.payload = payload;
+    freecanard_process_received_frame(&bus, &frame, 0, portMAX_DELAY);
+}
+
+static void test_on_response(CanardInstance *ins, freecanard_call_t *call, const CanardTransfer *const response)
+{
+    (void)ins;
+    (void)call;
+    async_completions++;
+    async_response_received = response != NULL;
+    async_response_size = response != NULL ? response->payload_size : 0;
+    xTaskNotifyGive(control_task_handle);
+}
+
+/**
+ * libcanard frees NULL whenever a transfer completes. While a provided
+ * buffer is on loan, this must neither reach the provider nor return the
+ * buffer early.
+ */
+static void test_rx_into_ignores_null_free(void)
+{
+    static const uint8_t payload[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    const uint16_t crc = test_crc(payload, sizeof(payload));
+    const uint8_t last[5] = {payload[7], payload[8], payload[9], (uint8_t)(crc >> 8U), (uint8_t)crc};
+    const uint8_t single[1] = {0x55};
+
+    provider.user_reference_ = NULL;
+    provider.acquire = test_provider_acquire;
+    provider.release = test_provider_release;
+    TEST_CHECK(freecanard_subscribe_into(
+                   &bus,
+                   CanardTransferKindMessage,
+                   TEST_PROVIDED_SUBJECT_ID,
+                   TEST_PROVIDED_EXTENT,
+                   CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
+                   &provided_subscription,
+                   &provider) >= 0);
+    TEST_CHECK(freecanard_subscribe(
+                   &bus,
+                   CanardTransferKindMessage,
+                   TEST_POOL_SUBJECT_ID,
+                   8,
+                   CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
+                   &pool_subscription) >= 0);
+
+    // The first frame of a multi-frame transfer borrows the buffer, then a
+    // transfer reassembled into the memory pool completes
+    test_enter_frame(TEST_PROVIDED_SUBJECT_ID, payload, 7, true, false, true, 0);
+    test_enter_frame(TEST_POOL_SUBJECT_ID, single, sizeof(single), true, true, true, 0);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(pool_transfers == 1);
+    TEST_CHECK(provider_acquired == 1);
+    TEST_CHECK(provider_released == 0);
+    TEST_CHECK(provider_released_foreign == 0);
+
+    test_enter_frame(TEST_PROVIDED_SUBJECT_ID, last, sizeof(last), false, true, false, 0);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(provided_transfers == 1);
+    TEST_CHECK(provided_payload_in_buffer);
+    TEST_CHECK(provided_payload_size == sizeof(payload));
+    TEST_CHECK(memcmp(provided_payload, payload, sizeof(payload)) == 0);
+    TEST_CHECK(provider_acquired == 1);
+    TEST_CHECK(provider_released == 1);
+    TEST_CHECK(provider_released_foreign == 0);
+
+    freecanard_unsubscribe(&bus, CanardTransferKindMessage, TEST_PROVIDED_SUBJECT_ID);
+    freecanard_unsubscribe(&bus, CanardTransferKindMessage, TEST_POOL_SUBJECT_ID);
+}
+
+static void test_stream_reset(void)
+{
+    stream_size = 0;
+    stream_end_size = 0;
+    stream_ends = 0;
+    stream_aborts = 0;
+    stream_out_of_order = false;
+}
+
+/**
+ * Enter a 20-byte payload and its CRC as four frames: three full ones, the
+ * third ending with the first CRC byte, and one holding the last CRC byte.
+ */
+static void test_stream_enter(const uint8_t *const payload, const uint16_t crc, const uint8_t transfer_id)
+{
+    const uint8_t third[7] = {
+        payload[14], payload[15], payload[16], payload[17], payload[18], payload[19], (uint8_t)(crc >> 8U)};
+    const uint8_t fourth[1] = {(uint8_t)crc};
+
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, &payload[0], 7, true, false, true, transfer_id);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, &payload[7], 7, false, false, false, transfer_id);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, third, sizeof(third), false, false, true, transfer_id);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, fourth, sizeof(fourth), false, true, false, transfer_id);
+}
+
+/**
+ * A multi-frame transfer is streamed in order, with the CRC held back across
+ * frames and never passed on as payload.
+ */
+static void test_stream_in_order(void)
+{
+    static const uint8_t payload[20] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+
+    test_stream_reset();
+    test_stream_enter(payload, test_crc(payload, sizeof(payload)), 0);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(stream_ends == 1);
+    TEST_CHECK(stream_aborts == 0);
+    TEST_CHECK(!stream_out_of_order);
+    TEST_CHECK(stream_end_size == sizeof(payload));
+    TEST_CHECK(stream_size == sizeof(payload));
+    TEST_CHECK(memcmp(stream_payload, payload, sizeof(payload)) == 0);
+}
+
+/**
+ * A transfer with an invalid CRC ends with an abort instead of an end, and
+ * is accounted for in the statistics.
+ */
+static void test_stream_crc_abort(void)
+{
+    static const uint8_t payload[20] = {20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39};
+    freecanard_stats_t before;
+    freecanard_stats_t after;
+
+    test_stream_reset();
+    freecanard_get_stats(&bus, &before);
+    test_stream_enter(payload, (uint16_t)(test_crc(payload, sizeof(payload)) ^ 0x0100U), 1);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    freecanard_get_stats(&bus, &after);
+    TEST_CHECK(stream_ends == 0);
+    TEST_CHECK(stream_aborts == 1);
+    TEST_CHECK(after.rx_stream_aborts == before.rx_stream_aborts + 1U);
+}
+
+/**
+ * A frame with an unexpected toggle bit, such as a duplicate, is dropped
+ * without disturbing the transfer in progress.
+ */
+static void test_stream_toggle_error(void)
+{
+    static const uint8_t payload[20] = {40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59};
+    static const uint8_t garbage[7] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    const uint16_t crc = test_crc(payload, sizeof(payload));
+    const uint8_t third[7] = {
+        payload[14], payload[15], payload[16], payload[17], payload[18], payload[19], (uint8_t)(crc >> 8U)};
+    const uint8_t fourth[1] = {(uint8_t)crc};
+
+    test_stream_reset();
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, &payload[0], 7, true, false, true, 2);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, garbage, sizeof(garbage), false, false, true, 2);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, &payload[7], 7, false, false, false, 2);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, garbage, sizeof(garbage), false, false, false, 2);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, third, sizeof(third), false, false, true, 2);
+    test_enter_frame(TEST_STREAM_SUBJECT_ID, fourth, sizeof(fourth), false, true, false, 2);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(stream_ends == 1);
+    TEST_CHECK(stream_aborts == 0);
+    TEST_CHECK(!stream_out_of_order);
+    TEST_CHECK(stream_size == sizeof(payload));
+    TEST_CHECK(memcmp(stream_payload, payload, sizeof(payload)) == 0);
+}
+
+/**
+ * A response matching an outstanding call completes it, and is not passed to
+ * the transfer callback. A response no call awaits is.
+ */
+static void test_call_matching(void)
+{
+    static const uint8_t request[1] = {0x11};
+    uint8_t payload[4];
+    freecanard_response_t response = {.payload = payload, .payload_capacity = sizeof(payload)};
+
+    server_responds = true;
+    unmatched_responses = 0;
+    const int32_t res = freecanard_call(
+        &bus,
+        TEST_SERVICE_ID,
+        TEST_REMOTE_NODE_ID,
+        CanardPriorityNominal,
+        request,
+        sizeof(request),
+        TEST_TIMEOUT,
+        &response);
+    server_responds = false;
+    TEST_CHECK(res == 0);
+    TEST_CHECK(response.payload_size == 2);
+    TEST_CHECK(payload[0] == 0x22 && payload[1] == 0x33);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, 0) == 0);
+    TEST_CHECK(unmatched_responses == 0);
+
+    const CanardTransferID stray_transfer_id =
+        (CanardTransferID)((request_transfer_id + (CANARD_TRANSFER_ID_MAX + 1U) / 2U) & CANARD_TRANSFER_ID_MAX);
+    test_enter_response(stray_transfer_id, request, sizeof(request));
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(unmatched_responses == 1);
+    TEST_CHECK(unmatched_transfer_id == stray_transfer_id);
+}
+
+/**
+ * A blocking call without response times out, and a response arriving after
+ * it did is passed to the transfer callback.
+ */
+static void test_call_timeout(void)
+{
+    static const uint8_t request[1] = {0x44};
+    static const uint8_t late[1] = {0x55};
+    uint8_t payload[4];
+    freecanard_response_t response = {.payload = payload, .payload_capacity = sizeof(payload)};
+
+    unmatched_responses = 0;
+    const uint32_t sent = requests_sent;
+    const int32_t res = freecanard_call(
+        &bus,
+        TEST_SERVICE_ID,
+        TEST_REMOTE_NODE_ID,
+        CanardPriorityNominal,
+        request,
+        sizeof(request),
+        TEST_CALL_TIMEOUT,
+        &response);
+    TEST_CHECK(res == -FREECANARD_ERROR_CALL_TIMEOUT);
+    TEST_CHECK(requests_sent == sent + 1U);
+
+    test_enter_response(request_transfer_id, late, sizeof(late));
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(unmatched_responses == 1);
+    TEST_CHECK(unmatched_transfer_id == request_transfer_id);
+}
+
+/**
+ * An asynchronous call completes once, with its response or with NULL on
+ * timeout, and a response arriving after the timeout is passed to the
+ * transfer callback.
+ */
+static void test_call_async(void)
+{
+    static const uint8_t request[1] = {0x66};
+    static const uint8_t late[1] = {0x77};
+
+    server_responds = true;
+    async_completions = 0;
+    unmatched_responses = 0;
+    TEST_CHECK(freecanard_call_async(
+                   &bus,
+                   TEST_SERVICE_ID,
+                   TEST_REMOTE_NODE_ID,
+                   CanardPriorityNominal,
+                   request,
+                   sizeof(request),
+                   TEST_TIMEOUT,
+                   &async_call,
+                   test_on_response) == 0);
+    server_responds = false;
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(async_completions == 1);
+    TEST_CHECK(async_response_received);
+    TEST_CHECK(async_response_size == 2);
+
+    TEST_CHECK(freecanard_call_async(
+                   &bus,
+                   TEST_SERVICE_ID,
+                   TEST_REMOTE_NODE_ID,
+                   CanardPriorityNominal,
+                   request,
+                   sizeof(request),
+                   TEST_CALL_TIMEOUT,
+                   &async_call,
+                   test_on_response) == 0);
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(async_completions == 2);
+    TEST_CHECK(!async_response_received);
+
+    test_enter_response(request_transfer_id, late, sizeof(late));
+    TEST_CHECK(ulTaskNotifyTake(pdTRUE, TEST_TIMEOUT) != 0);
+    TEST_CHECK(async_completions == 2);
+    TEST_CHECK(unmatched_responses == 1);
+    TEST_CHECK(unmatched_transfer_id == request_transfer_id);
+}
+
+static void test_control_task(void *parameters)
+{
+    (void)parameters;
+
+    test_rx_into_ignores_null_free();
+
+    TEST_CHECK(freecanard_subscribe_stream(
+                   &bus,
+                   CanardTransferKindMessage,
+                   TEST_STREAM_SUBJECT_ID,
+                   CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
+                   &stream,
+                   test_on_stream) == 1);
+    test_stream_in_order();
+    test_stream_crc_abort();
+    test_stream_toggle_error();
+    TEST_CHECK(freecanard_unsubscribe_stream(&bus, CanardTransferKindMessage, TEST_STREAM_SUBJECT_ID) == 1);
+
+    TEST_CHECK(freecanard_subscribe(
+                   &bus,
+                   CanardTransferKindResponse,
+                   TEST_SERVICE_ID,
+                   8,
+                   CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC,
+                   &response_subscription) >= 0);
+    test_call_matching();
+    test_call_timeout();
+    test_call_async();
+    freecanard_unsubscribe(&bus, CanardTransferKindResponse, TEST_SERVICE_ID);
+
+    printf("%s\n", test_failures == 0 ? "All tests passed" : "Some tests failed");
+    fflush(stdout);
+    vTaskEndScheduler();
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    if (!freecanard_init(
+            &bus,
+            &cookie,
+            1,
+            CANARD_MTU_CAN_CLASSIC,
+            memory_pool,
+            TEST_MEMORY_POOL_SIZE,
+            TEST_PROCESSING_PRIORITY,
+            FREECANARD_DEFAULT_PROCESSING_TASK_QUEUE_SIZE,
+            FREECANARD_DEFAULT_PROCESSING_TASK_STACK_SIZE,
+            test_send,
+            test_on_transfer_received))
+    {
+        printf("Unable to initialize the bus\n");
+        return 1;
+    }
+
+    xTaskCreate(test_control_task, "TestControl", configMINIMAL_STACK_SIZE, NULL, TEST_CONTROL_PRIORITY, &control_task_handle);
+
+    vTaskStartScheduler();
+    return test_failures == 0 ? 0 : 1;
+}
+
+/* configSUPPORT_STATIC_ALLOCATION is set to 1, so the application must
+provide the memory used by the Idle and Timer tasks. */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
@@ -4,15 +4,121 @@
 #include <string.h>
 
 /**
- * @brief CAN(-FD) data frame.
- * 
+ * @brief Mirror of the private CanardInternalRxSession in canard.c.
+ *
+ * Libcanard offers no way of releasing a single RX session, so the eviction
+ * sweep needs to know where a session keeps its start-of-transfer timestamp
+ * and its partially reassembled payload.
+ *
+ * @warning Must be kept in sync with the libcanard submodule.
+ */
+typedef struct
+{
+    CanardMicrosecond transfer_timestamp_usec;
+    size_t total_payload_size;
+    size_t payload_size;
+    uint8_t *payload;
+    uint16_t calculated_crc;
+    CanardTransferID transfer_id;
+    uint8_t redundant_transport_index;
+    bool toggle;
+} freecanard_rx_session_t;
+
+/**
+ * @brief Completed transfer handed over to a worker task.
  */
 typedef struct
 {
-    uint32_t id;
-    uint8_t data[CANARD_MTU_CAN_FD];
-    size_t data_len;
-} freecanard_frame_t;
+    CanardInstance *ins;
+    CanardTransfer transfer;
+} freecanard_work_item_t;
+
+/**
+ * @brief Subscription change handed to the processing task.
+ *
+ * Lives on the stack of the requesting task, which waits for the change to
+ * be applied before returning.
+ */
+typedef struct freecanard_rx_update
+{
+    struct freecanard_rx_update *next;
+    bool subscribe;
+    CanardTransferKind transfer_kind;
+    CanardPortID port_id;
+    size_t extent;
+    CanardMicrosecond transfer_id_timeout_usec;
+    CanardRxSubscription *subscription;
+    bool streaming;
+    freecanard_stream_t *stream;
+    freecanard_on_stream on_stream;
+    freecanard_buffer_provider_t *provider;
+    freecanard_mailbox_t *mailbox;
+    uint8_t *mailbox_buffer;
+    freecanard_delivery_queue_t *delivery_queue;
+    int8_t result;
+    SemaphoreHandle_t done;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    StaticSemaphore_t done_buffer;
+#endif
+} freecanard_rx_update_t;
+
+#define FREECANARD_USEC_PER_TICK (1000000ULL / configTICK_RATE_HZ)
+
+#if FREECANARD_NUM_CORES > 1
+#define FREECANARD_CORE_ID() ((UBaseType_t)portGET_CORE_ID())
+#else
+#define FREECANARD_CORE_ID() ((UBaseType_t)0)
+#endif
+
+#if (configUSE_TIMERS == 1) && (INCLUDE_xTimerPendFunctionCall == 1) && (INCLUDE_vTaskPrioritySet == 1)
+#define FREECANARD_PRIORITY_BOOST 1
+#else
+#define FREECANARD_PRIORITY_BOOST 0
+#endif
+
+/**
+ * States of the processing task priority boost. A boost requested from an
+ * ISR is pending until the timer service task carries it out.
+ */
+#define FREECANARD_BOOST_IDLE 0U
+#define FREECANARD_BOOST_REQUESTED 1U
+#define FREECANARD_BOOST_ACTIVE 2U
+
+/**
+ * Middle slot of a mailbox: the index of the slot, and whether it holds a
+ * sample the reader has not seen yet.
+ */
+#define FREECANARD_MAILBOX_INDEX 0x03U
+#define FREECANARD_MAILBOX_FRESH 0x80U
+
+/**
+ * Statistics are updated and read without locks, so that updating them never
+ * makes tasks on different cores contend.
+ */
+#define FREECANARD_STATS_ADD(cookie, field, value) \
+    ((void)__atomic_fetch_add(&(cookie)->_stats.field, (value), __ATOMIC_RELAXED))
+#define FREECANARD_STATS_LOAD(cookie, field) __atomic_load_n(&(cookie)->_stats.field, __ATOMIC_RELAXED)
+#define FREECANARD_STATS_STORE(cookie, field, value) \
+    __atomic_store_n(&(cookie)->_stats.field, (value), __ATOMIC_RELAXED)
+
+static bool freecanard_resources_created(const freecanard_cookie_t *const cookie);
+static void freecanard_delete_resources(freecanard_cookie_t *const cookie);
+static bool freecanard_init_instance(
+    CanardInstance *const ins,
+    freecanard_cookie_t *const cookie,
+    const uint8_t canard_node_id,
+    const size_t mtu_bytes,
+    uint8_t *memory_pool,
+    const size_t memory_pool_size,
+    freecanard_platform_send platform_send,
+    freecanard_on_transfer_received on_transfer_received);
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+static void *freecanard_arena_carve(uint8_t **const cursor, const size_t size);
+#endif
+
+static void freecanard_heap_enter_critical(void);
+static void freecanard_heap_leave_critical(void);
 
 static void freecanard_take_mutex(SemaphoreHandle_t *const mutex);
 static void freecanard_give_mutex(SemaphoreHandle_t *const mutex);
@@ -20,20 +126,179 @@ static void freecanard_give_mutex(SemaphoreHandle_t *const mutex);
 static void *memory_allocate(CanardInstance *ins, size_t amount);
 static void memory_free(CanardInstance *ins, void *pointer);
 
+static int8_t freecanard_update_subscriptions(CanardInstance *const ins, freecanard_rx_update_t *const update);
+static void freecanard_apply_rx_updates(CanardInstance *const ins);
+static void freecanard_apply_rx_update(CanardInstance *const ins, freecanard_rx_update_t *const update);
+static void freecanard_wake_processing(freecanard_cookie_t *const cookie);
+
+static CanardRxSubscription *freecanard_find_subscription(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id);
+static void freecanard_payload_pool_acquire(freecanard_cookie_t *const cookie, const size_t extent);
+static void freecanard_payload_pool_release(CanardInstance *const ins, const size_t extent);
+static bool freecanard_payload_pool_flush(CanardInstance *const ins);
+static void freecanard_release_rx_payload(CanardInstance *const ins, const CanardTransfer *const transfer);
+static void freecanard_apply_provider_update(freecanard_cookie_t *const cookie, const freecanard_rx_update_t *const update);
+static void freecanard_apply_mailbox_update(freecanard_cookie_t *const cookie, const freecanard_rx_update_t *const update);
+static bool freecanard_deliver_sample(freecanard_cookie_t *const cookie, const CanardTransfer *const transfer);
+static void freecanard_apply_delivery_queue_update(
+    freecanard_cookie_t *const cookie,
+    const freecanard_rx_update_t *const update);
+static bool freecanard_deliver_queued(freecanard_cookie_t *const cookie, const CanardTransfer *const transfer);
+static void freecanard_stage_queued(freecanard_delivery_queue_t *const queue, const CanardTransfer *const transfer);
+static void freecanard_set_rx_into_hint(
+    CanardInstance *const ins,
+    const freecanard_frame_t *const frame,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id);
+static void *freecanard_rx_into_acquire(freecanard_cookie_t *const cookie, const size_t amount);
+static bool freecanard_rx_into_release(freecanard_cookie_t *const cookie, void *const buffer);
+
 static void freecanard_to_canard_frame(const freecanard_frame_t *const can_frame, CanardFrame *const canard_frame);
 static void canard_to_freecanard_frame(const CanardFrame *const canard_frame, freecanard_frame_t *const can_frame);
 
-static void freecanard_transmit_transfer(CanardInstance *const ins, const CanardTransfer *const transfer);
+static int32_t freecanard_admit_transfer(CanardInstance *const ins, const CanardTransfer *const transfer);
+static int32_t freecanard_transmit_transfer(CanardInstance *const ins, const CanardTransfer *const transfer);
+static bool freecanard_flush_tx_queue(CanardInstance *const ins);
 static void freecanard_processing_task(void *canard_instance);
 
-typedef struct
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1) && (configUSE_QUEUE_SETS == 1)
+static void freecanard_reactor_task(void *reactor_handle);
+static size_t freecanard_reactor_find_bus(const freecanard_reactor_t *const reactor, QueueSetMemberHandle_t member);
+static void freecanard_reactor_service(freecanard_reactor_t *const reactor, const size_t bus_count);
+#endif
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+static void freecanard_worker_task(void *worker_queue);
+#endif
+
+#if (configUSE_TIMERS == 1)
+static void freecanard_rx_coalesce_timer_callback(TimerHandle_t timer);
+#endif
+static bool freecanard_rx_coalesce_from_ISR(
+    freecanard_cookie_t *const cookie,
+    const bool enqueued,
+    BaseType_t *const higher_priority_task_woken);
+
+static void freecanard_request_priority_boost(
+    CanardInstance *const ins,
+    QueueHandle_t queue,
+    const bool from_ISR,
+    BaseType_t *const higher_priority_task_woken);
+static void freecanard_end_priority_boost(CanardInstance *const ins);
+#if FREECANARD_PRIORITY_BOOST
+static void freecanard_apply_priority_boost(void *canard_instance, uint32_t unused);
+static void freecanard_record_priority_boost(freecanard_cookie_t *const cookie);
+static void freecanard_sync_boost_priority(freecanard_cookie_t *const cookie);
+static UBaseType_t freecanard_rx_queue_occupancy(const freecanard_cookie_t *const cookie);
+#endif
+
+static int32_t freecanard_start_call(
+    CanardInstance *const ins,
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardPriority priority,
+    const void *const request_payload,
+    const size_t request_payload_size,
+    const TickType_t timeout,
+    freecanard_call_t *const call);
+static size_t freecanard_call_bucket(
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardTransferID transfer_id);
+static bool freecanard_remove_call(freecanard_cookie_t *const cookie, const freecanard_call_t *const call);
+static bool freecanard_complete_call(CanardInstance *const ins, const CanardTransfer *const transfer);
+static void freecanard_expire_calls(CanardInstance *const ins);
+static TickType_t freecanard_call_timeout(const freecanard_cookie_t *const cookie);
+
+static CanardPortID freecanard_parse_port(const uint32_t can_id, CanardTransferKind *const out_transfer_kind);
+static int8_t freecanard_apply_stream_update(freecanard_cookie_t *const cookie, const freecanard_rx_update_t *const update);
+static bool freecanard_accept_stream_frame(CanardInstance *const ins, const freecanard_frame_queue_item_t *const queue_item);
+static void freecanard_stream_frame(
+    CanardInstance *const ins,
+    freecanard_stream_t *const stream,
+    const freecanard_frame_queue_item_t *const queue_item,
+    const CanardNodeID source_node_id);
+static void freecanard_stream_emit(
+    CanardInstance *const ins,
+    freecanard_stream_t *const stream,
+    const freecanard_stream_event_t event,
+    const uint8_t *const payload,
+    const size_t payload_size,
+    const size_t offset);
+static uint16_t freecanard_crc_add(uint16_t crc, const uint8_t *data, size_t size);
+
+static void freecanard_deliver_transfer(CanardInstance *const ins, CanardTransfer *const transfer);
+static void freecanard_deliver_local(CanardInstance *const ins, const CanardTransfer *const transfer);
+static void freecanard_process_queue_item(CanardInstance *const ins, const freecanard_frame_queue_item_t *const queue_item);
+static void freecanard_drain_rx_queues(CanardInstance *const ins);
+static TickType_t freecanard_processing_timeout(const freecanard_cookie_t *const cookie);
+static void freecanard_run_rx_session_eviction(CanardInstance *const ins);
+static size_t freecanard_evict_rx_sessions(CanardInstance *const ins, const CanardMicrosecond now_usec);
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_init(
+    CanardInstance *const ins,
+    freecanard_cookie_t *const cookie,
+    const uint8_t canard_node_id,
+    const size_t mtu_bytes,
+    uint8_t *memory_pool,
+    const size_t memory_pool_size,
+    const UBaseType_t processing_task_priority,
+    const UBaseType_t processing_task_queue_size,
+    const configSTACK_DEPTH_TYPE processing_task_stack_size,
+    freecanard_platform_send platform_send,
+    freecanard_on_transfer_received on_transfer_received)
 {
-    const freecanard_frame_t frame_;
-    CanardMicrosecond timestamp_usec;
-    const uint8_t redundant_transport_index_;
-} freecanard_frame_queue_item_t;
+    cookie->_rx_mutex = xSemaphoreCreateMutex();
+    cookie->_tx_mutex = xSemaphoreCreateMutex();
+    cookie->_processing_task_queue = xQueueCreate(processing_task_queue_size, sizeof(freecanard_frame_queue_item_t));
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 0; core < FREECANARD_NUM_CORES - 1; core++)
+    {
+        cookie->_rx_core_queues[core] = xQueueCreate(processing_task_queue_size, sizeof(freecanard_frame_queue_item_t));
+    }
+#endif
+
+    if (!freecanard_resources_created(cookie) ||
+        !freecanard_init_instance(
+            ins,
+            cookie,
+            canard_node_id,
+            mtu_bytes,
+            memory_pool,
+            memory_pool_size,
+            platform_send,
+            on_transfer_received))
+    {
+        freecanard_delete_resources(cookie);
+        return false;
+    }
+
+    if (processing_task_stack_size != FREECANARD_NO_PROCESSING_TASK)
+    {
+        if (xTaskCreate(
+                freecanard_processing_task,
+                "FreecanardProcessingTask",
+                processing_task_stack_size,
+                (void *)ins,
+                processing_task_priority,
+                &cookie->_processing_task) != pdPASS)
+        {
+            cookie->_processing_task = NULL;
+            freecanard_delete_resources(cookie);
+            return false;
+        }
+        cookie->_processing_task_notify = true;
+        cookie->_processing_task_priority = processing_task_priority;
+    }
+    return true;
+}
+#endif
 
-void freecanard_init(
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_init_static(
     CanardInstance *const ins,
     freecanard_cookie_t *const cookie,
     const uint8_t canard_node_id,
@@ -41,54 +306,474 @@ void freecanard_init(
     uint8_t *memory_pool,
     const size_t memory_pool_size,
     const UBaseType_t processing_task_priority,
-    const UBaseType_t processing_task_size,
+    const UBaseType_t processing_task_queue_size,
+    const configSTACK_DEPTH_TYPE processing_task_stack_size,
+    freecanard_platform_send platform_send,
+    freecanard_on_transfer_received on_transfer_received,
+    const freecanard_static_buffers_t *const buffers)
+{
+    cookie->_rx_mutex = xSemaphoreCreateMutexStatic(buffers->rx_mutex_buffer);
+    cookie->_tx_mutex = xSemaphoreCreateMutexStatic(buffers->tx_mutex_buffer);
+    cookie->_processing_task_queue = xQueueCreateStatic(
+        processing_task_queue_size,
+        sizeof(freecanard_frame_queue_item_t),
+        buffers->processing_task_queue_storage,
+        buffers->processing_task_queue_buffer);
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 0; core < FREECANARD_NUM_CORES - 1; core++)
+    {
+        cookie->_rx_core_queues[core] = xQueueCreateStatic(
+            processing_task_queue_size,
+            sizeof(freecanard_frame_queue_item_t),
+            buffers->rx_core_queue_storage[core],
+            buffers->rx_core_queue_buffers[core]);
+    }
+#endif
+
+    if (!freecanard_resources_created(cookie) ||
+        !freecanard_init_instance(
+            ins,
+            cookie,
+            canard_node_id,
+            mtu_bytes,
+            memory_pool,
+            memory_pool_size,
+            platform_send,
+            on_transfer_received))
+    {
+        freecanard_delete_resources(cookie);
+        return false;
+    }
+
+    if (processing_task_stack_size != FREECANARD_NO_PROCESSING_TASK)
+    {
+        cookie->_processing_task = xTaskCreateStatic(
+            freecanard_processing_task,
+            "FreecanardProcessingTask",
+            processing_task_stack_size,
+            (void *)ins,
+            processing_task_priority,
+            buffers->processing_task_stack,
+            buffers->processing_task_buffer);
+        if (cookie->_processing_task == NULL)
+        {
+            freecanard_delete_resources(cookie);
+            return false;
+        }
+        cookie->_processing_task_notify = true;
+        cookie->_processing_task_priority = processing_task_priority;
+    }
+    return true;
+}
+#endif
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_init_arena(
+    CanardInstance *const ins,
+    const uint8_t canard_node_id,
+    const size_t mtu_bytes,
+    uint8_t *arena,
+    const size_t arena_size,
+    const UBaseType_t processing_task_priority,
+    const UBaseType_t processing_task_queue_size,
+    const configSTACK_DEPTH_TYPE processing_task_stack_size,
     freecanard_platform_send platform_send,
     freecanard_on_transfer_received on_transfer_received)
 {
-    cookie->_mutex = xSemaphoreCreateMutex();
-    cookie->_processing_task_queue = xQueueCreate(processing_task_size, sizeof(freecanard_frame_queue_item_t));
-    cookie->_platform_send = platform_send;
-    cookie->_on_transfer_received = on_transfer_received;
+    const size_t stack_bytes = (size_t)processing_task_stack_size * sizeof(StackType_t);
+    const size_t resources_size = FREECANARD_ARENA_SIZE(processing_task_queue_size, processing_task_stack_size, 0);
 
-    xTaskCreate(
-        freecanard_processing_task,
-        "FreecanardProcessingTask",
-        configMINIMAL_STACK_SIZE,
-        (void *)ins,
+    if (((uintptr_t)arena % FREECANARD_ARENA_ALIGNMENT) != 0 ||
+        arena_size < resources_size + FREECANARD_MIN_MEMORY_POOL_SIZE)
+    {
+        return false;
+    }
+
+    // Hot queue state first, cold statistics and task resources after
+    uint8_t *cursor = arena;
+    freecanard_static_buffers_t buffers;
+    buffers.processing_task_queue_buffer = freecanard_arena_carve(&cursor, sizeof(StaticQueue_t));
+    buffers.processing_task_queue_storage = freecanard_arena_carve(
+        &cursor,
+        FREECANARD_PROCESSING_TASK_QUEUE_STORAGE_SIZE(processing_task_queue_size));
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 0; core < FREECANARD_NUM_CORES - 1; core++)
+    {
+        buffers.rx_core_queue_buffers[core] = freecanard_arena_carve(&cursor, sizeof(StaticQueue_t));
+        buffers.rx_core_queue_storage[core] = freecanard_arena_carve(
+            &cursor,
+            FREECANARD_PROCESSING_TASK_QUEUE_STORAGE_SIZE(processing_task_queue_size));
+    }
+#endif
+    freecanard_cookie_t *cookie = freecanard_arena_carve(&cursor, sizeof(freecanard_cookie_t));
+    buffers.rx_mutex_buffer = freecanard_arena_carve(&cursor, sizeof(StaticSemaphore_t));
+    buffers.tx_mutex_buffer = freecanard_arena_carve(&cursor, sizeof(StaticSemaphore_t));
+    buffers.processing_task_buffer = freecanard_arena_carve(&cursor, sizeof(StaticTask_t));
+    buffers.processing_task_stack = freecanard_arena_carve(&cursor, stack_bytes);
+
+    memset(cookie, 0, sizeof(freecanard_cookie_t));
+
+    return freecanard_init_static(
+        ins,
+        cookie,
+        canard_node_id,
+        mtu_bytes,
+        cursor,
+        arena_size - (size_t)(cursor - arena),
         processing_task_priority,
-        NULL);
+        processing_task_queue_size,
+        processing_task_stack_size,
+        platform_send,
+        on_transfer_received,
+        &buffers);
+}
+#endif
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_workers_init(
+    CanardInstance *const ins,
+    const UBaseType_t worker_count,
+    const UBaseType_t worker_priority,
+    const configSTACK_DEPTH_TYPE worker_stack_size,
+    const UBaseType_t worker_queue_size)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (worker_count == 0 || worker_count > FREECANARD_MAX_WORKERS || cookie->_worker_count != 0)
+    {
+        return false;
+    }
+
+    for (UBaseType_t i = 0; i < worker_count; i++)
+    {
+        cookie->_worker_queues[i] = xQueueCreate(worker_queue_size, sizeof(freecanard_work_item_t));
+        if (cookie->_worker_queues[i] == NULL ||
+            xTaskCreate(
+                freecanard_worker_task,
+                "FreecanardWorkerTask",
+                worker_stack_size,
+                (void *)cookie->_worker_queues[i],
+                worker_priority,
+                &cookie->_worker_tasks[i]) != pdPASS)
+        {
+            if (cookie->_worker_queues[i] != NULL)
+            {
+                vQueueDelete(cookie->_worker_queues[i]);
+                cookie->_worker_queues[i] = NULL;
+            }
+#if (INCLUDE_vTaskDelete == 1)
+            // Nothing has been dispatched yet, so the workers created so far
+            // are idle and can be torn down
+            while (i-- > 0)
+            {
+                vTaskDelete(cookie->_worker_tasks[i]);
+                vQueueDelete(cookie->_worker_queues[i]);
+                cookie->_worker_tasks[i] = NULL;
+                cookie->_worker_queues[i] = NULL;
+            }
+#endif
+            return false;
+        }
+    }
+
+    // Only start dispatching once all workers exist
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    cookie->_worker_count = worker_count;
+    freecanard_give_mutex(&cookie->_rx_mutex);
+    return true;
+}
+#endif
+
+bool freecanard_set_core_affinity(
+    CanardInstance *const ins,
+    const UBaseType_t processing_task_core_mask,
+    const UBaseType_t worker_core_mask)
+{
+#if (FREECANARD_NUM_CORES > 1) && (configUSE_CORE_AFFINITY == 1)
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (cookie->_processing_task != NULL)
+    {
+        vTaskCoreAffinitySet(cookie->_processing_task, processing_task_core_mask);
+    }
+    for (UBaseType_t i = 0; i < cookie->_worker_count; i++)
+    {
+        vTaskCoreAffinitySet(cookie->_worker_tasks[i], worker_core_mask);
+    }
+    return true;
+#else
+    (void)ins;
+    (void)processing_task_core_mask;
+    (void)worker_core_mask;
+    return false;
+#endif
+}
+
+bool freecanard_set_rx_coalescing(
+    CanardInstance *const ins,
+    const UBaseType_t frame_threshold,
+    const uint32_t max_latency_usec)
+{
+#if (configUSE_TIMERS == 1)
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (!cookie->_processing_task_notify)
+    {
+        return false;
+    }
+
+    TickType_t period = (TickType_t)(((uint64_t)max_latency_usec + FREECANARD_USEC_PER_TICK - 1U) / FREECANARD_USEC_PER_TICK);
+    period = period > 0 ? period : 1;
+
+    // The mutex only serializes concurrent reconfigurations, the ISR path
+    // synchronizes through critical sections
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    if (cookie->_rx_coalesce_timer == NULL)
+    {
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        cookie->_rx_coalesce_timer = xTimerCreateStatic(
+            "FreecanardCoalesceTimer",
+            period,
+            pdFALSE,
+            (void *)ins,
+            freecanard_rx_coalesce_timer_callback,
+            &cookie->_rx_coalesce_timer_buffer);
+#else
+        cookie->_rx_coalesce_timer = xTimerCreate(
+            "FreecanardCoalesceTimer",
+            period,
+            pdFALSE,
+            (void *)ins,
+            freecanard_rx_coalesce_timer_callback);
+#endif
+    }
+
+    const bool configured = cookie->_rx_coalesce_timer != NULL;
+    if (configured)
+    {
+        // Disable while the period changes, and have the frames pending so
+        // far processed right away
+        taskENTER_CRITICAL();
+        cookie->_rx_coalesce_frames = 0;
+        cookie->_rx_coalesce_pending = 0;
+        taskEXIT_CRITICAL();
+
+        xTimerChangePeriod(cookie->_rx_coalesce_timer, period, portMAX_DELAY);
+        xTimerStop(cookie->_rx_coalesce_timer, portMAX_DELAY);
+        xTaskNotifyGive(cookie->_processing_task);
+
+        taskENTER_CRITICAL();
+        cookie->_rx_coalesce_frames = frame_threshold;
+        taskEXIT_CRITICAL();
+    }
+    freecanard_give_mutex(&cookie->_rx_mutex);
+    return configured;
+#else
+    (void)ins;
+    (void)frame_threshold;
+    (void)max_latency_usec;
+    return false;
+#endif
+}
+
+bool freecanard_set_priority_boost(
+    CanardInstance *const ins,
+    const UBaseType_t high_watermark,
+    const UBaseType_t low_watermark,
+    const UBaseType_t boost_priority)
+{
+#if FREECANARD_PRIORITY_BOOST
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (!cookie->_processing_task_notify)
+    {
+        return false;
+    }
+
+    // The mutex only serializes concurrent reconfigurations
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    taskENTER_CRITICAL();
+    const bool was_active = cookie->_boost_state == FREECANARD_BOOST_ACTIVE;
+    if (was_active)
+    {
+        freecanard_record_priority_boost(cookie);
+    }
+    cookie->_boost_state = FREECANARD_BOOST_IDLE;
+    cookie->_boost_generation++;
+    cookie->_boost_high_watermark = high_watermark;
+    cookie->_boost_low_watermark = low_watermark;
+    cookie->_boost_priority = boost_priority;
+    taskEXIT_CRITICAL();
+    if (was_active)
+    {
+        freecanard_sync_boost_priority(cookie);
+    }
+    freecanard_give_mutex(&cookie->_rx_mutex);
+    return true;
+#else
+    (void)ins;
+    (void)high_watermark;
+    (void)low_watermark;
+    (void)boost_priority;
+    return false;
+#endif
+}
+
+/**
+ * @return true if the mutexes and the ingestion queues were all created.
+ */
+static bool freecanard_resources_created(const freecanard_cookie_t *const cookie)
+{
+    bool created = cookie->_rx_mutex != NULL && cookie->_tx_mutex != NULL && cookie->_processing_task_queue != NULL;
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 0; core < FREECANARD_NUM_CORES - 1; core++)
+    {
+        created = created && cookie->_rx_core_queues[core] != NULL;
+    }
+#endif
+    return created;
+}
+
+/**
+ * Delete the mutexes and the ingestion queues created by a failed
+ * initialization.
+ */
+static void freecanard_delete_resources(freecanard_cookie_t *const cookie)
+{
+    if (cookie->_rx_mutex != NULL)
+    {
+        vSemaphoreDelete(cookie->_rx_mutex);
+        cookie->_rx_mutex = NULL;
+    }
+    if (cookie->_tx_mutex != NULL)
+    {
+        vSemaphoreDelete(cookie->_tx_mutex);
+        cookie->_tx_mutex = NULL;
+    }
+    if (cookie->_processing_task_queue != NULL)
+    {
+        vQueueDelete(cookie->_processing_task_queue);
+        cookie->_processing_task_queue = NULL;
+    }
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 0; core < FREECANARD_NUM_CORES - 1; core++)
+    {
+        if (cookie->_rx_core_queues[core] != NULL)
+        {
+            vQueueDelete(cookie->_rx_core_queues[core]);
+            cookie->_rx_core_queues[core] = NULL;
+        }
+    }
+#endif
+}
+
+/**
+ * Initialize the cookie and the canard instance. The mutex and the processing
+ * task queue must be created beforehand, and the processing task afterwards.
+ *
+ * @return false if o1heap rejected the memory pool as too small.
+ */
+static bool freecanard_init_instance(
+    CanardInstance *const ins,
+    freecanard_cookie_t *const cookie,
+    const uint8_t canard_node_id,
+    const size_t mtu_bytes,
+    uint8_t *memory_pool,
+    const size_t memory_pool_size,
+    freecanard_platform_send platform_send,
+    freecanard_on_transfer_received on_transfer_received)
+{
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    freecanard_take_mutex(&cookie->_tx_mutex);
+    cookie->_processing_task = NULL;
+    cookie->_processing_task_notify = false;
+    cookie->_processing_wakeup = NULL;
+    cookie->_rx_updates = NULL;
+    cookie->_processing_task_priority = 0;
+    cookie->_boost_priority = 0;
+    cookie->_boost_high_watermark = 0;
+    cookie->_boost_low_watermark = 0;
+    cookie->_boost_state = FREECANARD_BOOST_IDLE;
+    cookie->_boost_generation = 0;
+    cookie->_boost_start_tick = 0;
+    memset(cookie->_calls, 0, sizeof(cookie->_calls));
+    cookie->_call_transfer_id = 0;
+    cookie->_calls_async_pending = 0;
+#if (configUSE_TIMERS == 1)
+    cookie->_rx_coalesce_timer = NULL;
+    cookie->_rx_coalesce_frames = 0;
+    cookie->_rx_coalesce_pending = 0;
+#endif
+    cookie->_worker_count = 0;
+    cookie->_platform_send = platform_send;
+    cookie->_on_transfer_received = on_transfer_received;
+    cookie->_on_tx_drained = NULL;
+    cookie->_rx_port_filter = NULL;
+    cookie->_loopback = false;
+    cookie->_streams = NULL;
+    cookie->_mailboxes = NULL;
+    cookie->_delivery_queues = NULL;
+    cookie->_rx_into_providers = NULL;
+    cookie->_rx_into_hint = NULL;
+    cookie->_rx_into_hint_skip_session = false;
+    cookie->_rx_into_outstanding = 0;
+    memset(cookie->_rx_into_buffers, 0, sizeof(cookie->_rx_into_buffers));
+    cookie->_rx_session_eviction_multiple = 0;
+    cookie->_rx_session_eviction_period = portMAX_DELAY;
+    cookie->_rx_session_eviction_last_tick = 0;
+    cookie->_rx_last_timestamp_usec = 0;
+    cookie->_rx_last_tick = 0;
+    cookie->_tx_soft_watermark = SIZE_MAX;
+    cookie->_tx_hard_watermark = SIZE_MAX;
+    cookie->_tx_soft_watermark_priority = CanardPriorityOptional;
+    memset(cookie->_rx_payload_pools, 0, sizeof(cookie->_rx_payload_pools));
+    memset(&cookie->_stats, 0, sizeof(cookie->_stats));
 
-    freecanard_take_mutex(&cookie->_mutex);
+    // The heap is shared by the reception and transmission instances, which
+    // are guarded by different mutexes. All heap operations are O(1).
     cookie->_o1heap = o1heapInit(
         memory_pool,
         memory_pool_size,
-        NULL,  // We don't need mutexes as heap accesses ...
-        NULL); // ... will always be performed within the freecanard mutexes
+        freecanard_heap_enter_critical,
+        freecanard_heap_leave_critical);
     *ins = canardInit(memory_allocate, memory_free);
     ins->node_id = canard_node_id;
     ins->mtu_bytes = mtu_bytes;
     ins->user_reference = (void *)cookie;
-    freecanard_give_mutex(&cookie->_mutex);
+
+    cookie->_tx_ins = canardInit(memory_allocate, memory_free);
+    cookie->_tx_ins.node_id = canard_node_id;
+    cookie->_tx_ins.mtu_bytes = mtu_bytes;
+    cookie->_tx_ins.user_reference = (void *)cookie;
+    freecanard_give_mutex(&cookie->_tx_mutex);
+    freecanard_give_mutex(&cookie->_rx_mutex);
+    return cookie->_o1heap != NULL;
 }
 
 void freecanard_set_node_id(CanardInstance *const ins, const uint8_t node_id)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    freecanard_take_mutex(&cookie->_mutex);
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    freecanard_take_mutex(&cookie->_tx_mutex);
 
     ins->node_id = node_id;
+    cookie->_tx_ins.node_id = node_id;
 
-    freecanard_give_mutex(&cookie->_mutex);
+    freecanard_give_mutex(&cookie->_tx_mutex);
+    freecanard_give_mutex(&cookie->_rx_mutex);
 }
 
 void freecanard_set_mtu_bytes(CanardInstance *const ins, const size_t mtu_bytes)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    freecanard_take_mutex(&cookie->_mutex);
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    freecanard_take_mutex(&cookie->_tx_mutex);
 
     ins->mtu_bytes = mtu_bytes;
+    cookie->_tx_ins.mtu_bytes = mtu_bytes;
 
-    freecanard_give_mutex(&cookie->_mutex);
+    freecanard_give_mutex(&cookie->_tx_mutex);
+    freecanard_give_mutex(&cookie->_rx_mutex);
 }
 
 void freecanard_set_user_reference(CanardInstance *const ins, void *user_reference)
@@ -114,163 +799,2675 @@ void *freecanard_get_user_reference(CanardInstance *const ins)
     return cookie->user_reference_;
 }
 
-int8_t freecanard_subscribe(
-    CanardInstance *const ins,
-    const CanardTransferKind transfer_kind,
-    const CanardPortID port_id,
-    const size_t extent,
-    const CanardMicrosecond transfer_id_timeout_usec,
-    CanardRxSubscription *const out_subscription)
+void freecanard_get_stats(CanardInstance *const ins, freecanard_stats_t *const out_stats)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    freecanard_take_mutex(&cookie->_mutex);
 
-    int8_t res = canardRxSubscribe(
-        ins,
-        transfer_kind,
-        port_id,
-        extent,
-        transfer_id_timeout_usec,
-        out_subscription);
-    freecanard_give_mutex(&cookie->_mutex);
-    return res;
+    out_stats->rx_sessions_evicted = FREECANARD_STATS_LOAD(cookie, rx_sessions_evicted);
+    out_stats->rx_session_bytes_reclaimed = FREECANARD_STATS_LOAD(cookie, rx_session_bytes_reclaimed);
+    out_stats->tx_transfers_shed = FREECANARD_STATS_LOAD(cookie, tx_transfers_shed);
+    out_stats->tx_out_of_memory = FREECANARD_STATS_LOAD(cookie, tx_out_of_memory);
+    out_stats->rx_payload_pool_hits = FREECANARD_STATS_LOAD(cookie, rx_payload_pool_hits);
+    out_stats->rx_worker_queue_overflows = FREECANARD_STATS_LOAD(cookie, rx_worker_queue_overflows);
+    out_stats->processing_priority_boosts = FREECANARD_STATS_LOAD(cookie, processing_priority_boosts);
+    out_stats->processing_priority_boost_ticks = FREECANARD_STATS_LOAD(cookie, processing_priority_boost_ticks);
+    out_stats->processing_priority_boost_max_ticks = FREECANARD_STATS_LOAD(cookie, processing_priority_boost_max_ticks);
+    out_stats->rx_frames_filtered = FREECANARD_STATS_LOAD(cookie, rx_frames_filtered);
+    out_stats->rx_loopback_transfers = FREECANARD_STATS_LOAD(cookie, rx_loopback_transfers);
+    out_stats->rx_stream_aborts = FREECANARD_STATS_LOAD(cookie, rx_stream_aborts);
 }
 
-int8_t freecanard_unsubscribe(
+void freecanard_set_rx_session_eviction(
     CanardInstance *const ins,
-    const CanardTransferKind transfer_kind,
-    const CanardPortID port_id)
+    const uint8_t transfer_id_timeout_multiple,
+    const TickType_t sweep_period)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    freecanard_take_mutex(&cookie->_mutex);
+    freecanard_take_mutex(&cookie->_rx_mutex);
 
-    int8_t res = canardRxUnsubscribe(ins, transfer_kind, port_id);
-    freecanard_give_mutex(&cookie->_mutex);
-    return res;
+    cookie->_rx_session_eviction_multiple = transfer_id_timeout_multiple;
+    cookie->_rx_session_eviction_period = sweep_period;
+    cookie->_rx_session_eviction_last_tick = xTaskGetTickCount();
+
+    freecanard_give_mutex(&cookie->_rx_mutex);
 }
 
-void freecanard_transmit(CanardInstance *const ins, const CanardTransfer *const transfer)
+size_t freecanard_evict_stale_rx_sessions(CanardInstance *const ins)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    freecanard_take_mutex(&cookie->_mutex);
+    freecanard_take_mutex(&cookie->_rx_mutex);
 
-    freecanard_transmit_transfer(ins, transfer);
+    const TickType_t elapsed_ticks = xTaskGetTickCount() - cookie->_rx_last_tick;
+    size_t reclaimed = freecanard_evict_rx_sessions(
+        ins,
+        cookie->_rx_last_timestamp_usec + elapsed_ticks * FREECANARD_USEC_PER_TICK);
 
-    freecanard_give_mutex(&cookie->_mutex);
+    freecanard_give_mutex(&cookie->_rx_mutex);
+    return reclaimed;
 }
 
-void freecanard_process_received_frame(
+void freecanard_set_tx_admission(
     CanardInstance *const ins,
-    const CanardFrame *const frame,
-    const uint8_t redundant_transport_index,
-    TickType_t timeout)
+    const size_t soft_watermark,
+    const CanardPriority soft_watermark_priority,
+    const size_t hard_watermark)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    freecanard_take_mutex(&cookie->_tx_mutex);
 
-    freecanard_frame_t freecanard_frame;
-    canard_to_freecanard_frame(frame, &freecanard_frame);
+    cookie->_tx_soft_watermark = soft_watermark;
+    cookie->_tx_soft_watermark_priority = soft_watermark_priority;
+    cookie->_tx_hard_watermark = hard_watermark;
 
-    freecanard_frame_queue_item_t queue_item = (freecanard_frame_queue_item_t){
-        .frame_ = freecanard_frame,
-        .timestamp_usec = frame->timestamp_usec,
-        .redundant_transport_index_ = redundant_transport_index};
-    xQueueSendToBack(cookie->_processing_task_queue, &queue_item, timeout);
+    freecanard_give_mutex(&cookie->_tx_mutex);
 }
 
-void freecanard_process_received_frame_from_ISR(
+int8_t freecanard_subscribe(
     CanardInstance *const ins,
-    const CanardFrame *const frame,
-    const uint8_t redundant_transport_index)
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const size_t extent,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription)
 {
-    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-
-    freecanard_frame_t freecanard_frame;
-    canard_to_freecanard_frame(frame, &freecanard_frame);
-
-    BaseType_t HigherPriorityTaskWoken = pdFALSE;
-    freecanard_frame_queue_item_t queue_item = (freecanard_frame_queue_item_t){
-        .frame_ = freecanard_frame,
-        .timestamp_usec = frame->timestamp_usec,
-        .redundant_transport_index_ = redundant_transport_index};
-
-    xQueueSendToBackFromISR(
-        cookie->_processing_task_queue,
-        &queue_item,
-        &HigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(HigherPriorityTaskWoken);
+    freecanard_rx_update_t update = {
+        .subscribe = true,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id,
+        .extent = extent,
+        .transfer_id_timeout_usec = transfer_id_timeout_usec,
+        .subscription = out_subscription};
+    return freecanard_update_subscriptions(ins, &update);
 }
 
-static void freecanard_processing_task(void *canard_instance)
+int8_t freecanard_unsubscribe(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id)
+{
+    freecanard_rx_update_t update = {
+        .subscribe = false,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id};
+    return freecanard_update_subscriptions(ins, &update);
+}
+
+int8_t freecanard_subscribe_into(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const size_t extent,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription,
+    freecanard_buffer_provider_t *const provider)
+{
+    freecanard_rx_update_t update = {
+        .subscribe = true,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id,
+        .extent = extent,
+        .transfer_id_timeout_usec = transfer_id_timeout_usec,
+        .subscription = out_subscription,
+        .provider = provider};
+    return freecanard_update_subscriptions(ins, &update);
+}
+
+int8_t freecanard_subscribe_stream(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    freecanard_stream_t *const stream,
+    freecanard_on_stream on_stream)
+{
+    freecanard_rx_update_t update = {
+        .subscribe = true,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id,
+        .transfer_id_timeout_usec = transfer_id_timeout_usec,
+        .streaming = true,
+        .stream = stream,
+        .on_stream = on_stream};
+    return freecanard_update_subscriptions(ins, &update);
+}
+
+int8_t freecanard_unsubscribe_stream(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id)
+{
+    freecanard_rx_update_t update = {
+        .subscribe = false,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id,
+        .streaming = true};
+    return freecanard_update_subscriptions(ins, &update);
+}
+
+int8_t freecanard_subscribe_sampled(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const size_t extent,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription,
+    freecanard_mailbox_t *const mailbox,
+    uint8_t *const buffer)
+{
+    freecanard_rx_update_t update = {
+        .subscribe = true,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id,
+        .extent = extent,
+        .transfer_id_timeout_usec = transfer_id_timeout_usec,
+        .subscription = out_subscription,
+        .mailbox = mailbox,
+        .mailbox_buffer = buffer};
+    return freecanard_update_subscriptions(ins, &update);
+}
+
+const CanardTransfer *freecanard_mailbox_read(freecanard_mailbox_t *const mailbox, bool *const out_fresh)
+{
+    // The front slot belongs to the reader, swap it for the newest sample
+    const bool fresh = (__atomic_load_n(&mailbox->_middle, __ATOMIC_RELAXED) & FREECANARD_MAILBOX_FRESH) != 0U;
+    if (fresh)
+    {
+        mailbox->_front = __atomic_exchange_n(&mailbox->_middle, mailbox->_front, __ATOMIC_ACQ_REL) &
+                          FREECANARD_MAILBOX_INDEX;
+        mailbox->_received = true;
+    }
+
+    if (out_fresh != NULL)
+    {
+        *out_fresh = fresh;
+    }
+    return mailbox->_received ? &mailbox->_samples[mailbox->_front] : NULL;
+}
+
+uint32_t freecanard_mailbox_written(const freecanard_mailbox_t *const mailbox)
+{
+    return __atomic_load_n(&mailbox->_written, __ATOMIC_RELAXED);
+}
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_delivery_queue_init(
+    freecanard_delivery_queue_t *const queue,
+    const size_t extent,
+    const UBaseType_t depth,
+    const freecanard_overflow_policy_t policy)
+{
+    queue->_next = NULL;
+    queue->_extent = extent;
+    queue->_policy = policy;
+    queue->_drops = 0;
+    queue->_staging = pvPortMalloc(FREECANARD_DELIVERY_ITEM_SIZE(extent));
+    queue->_queue = queue->_staging != NULL ? xQueueCreate(depth, FREECANARD_DELIVERY_ITEM_SIZE(extent)) : NULL;
+    if (queue->_queue == NULL)
+    {
+        vPortFree(queue->_staging);
+        queue->_staging = NULL;
+        return false;
+    }
+    return true;
+}
+#endif
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_delivery_queue_init_static(
+    freecanard_delivery_queue_t *const queue,
+    const size_t extent,
+    const UBaseType_t depth,
+    const freecanard_overflow_policy_t policy,
+    uint8_t *const storage)
+{
+    queue->_next = NULL;
+    queue->_extent = extent;
+    queue->_policy = policy;
+    queue->_drops = 0;
+
+    // The staging buffer comes first, followed by the items of the queue
+    queue->_staging = storage;
+    queue->_queue = xQueueCreateStatic(
+        depth,
+        FREECANARD_DELIVERY_ITEM_SIZE(extent),
+        storage + FREECANARD_DELIVERY_ITEM_SIZE(extent),
+        &queue->_queue_buffer);
+    return queue->_queue != NULL;
+}
+#endif
+
+int8_t freecanard_subscribe_queued(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription,
+    freecanard_delivery_queue_t *const queue)
+{
+    freecanard_rx_update_t update = {
+        .subscribe = true,
+        .transfer_kind = transfer_kind,
+        .port_id = port_id,
+        .extent = queue->_extent,
+        .transfer_id_timeout_usec = transfer_id_timeout_usec,
+        .subscription = out_subscription,
+        .delivery_queue = queue};
+    return freecanard_update_subscriptions(ins, &update);
+}
+
+bool freecanard_delivery_queue_receive(
+    freecanard_delivery_queue_t *const queue,
+    CanardTransfer *const out_transfer,
+    uint8_t *const buffer,
+    const TickType_t timeout)
+{
+    if (xQueueReceive(queue->_queue, buffer, timeout) != pdTRUE)
+    {
+        return false;
+    }
+
+    // Items are a transfer followed by its payload, the buffer may be unaligned
+    memcpy(out_transfer, buffer, sizeof(CanardTransfer));
+    out_transfer->payload = buffer + sizeof(CanardTransfer);
+    return true;
+}
+
+uint32_t freecanard_delivery_queue_drops(const freecanard_delivery_queue_t *const queue)
+{
+    return __atomic_load_n(&queue->_drops, __ATOMIC_RELAXED);
+}
+
+void freecanard_set_rx_port_filter(CanardInstance *const ins, const freecanard_port_filter_t *const filter)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    __atomic_store_n(&cookie->_rx_port_filter, filter, __ATOMIC_RELEASE);
+}
+
+int32_t freecanard_transmit(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    const int32_t res = freecanard_transmit_remote(ins, transfer);
+
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    // Local subscribers see exactly the messages the remote ones may see,
+    // none that were rejected, shed by admission control or out of memory
+    if (res >= 0 &&
+        transfer->transfer_kind == CanardTransferKindMessage &&
+        __atomic_load_n(&cookie->_loopback, __ATOMIC_RELAXED))
+    {
+        freecanard_deliver_local(ins, transfer);
+    }
+    return res;
+}
+
+int32_t freecanard_transmit_remote(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    freecanard_take_mutex(&cookie->_tx_mutex);
+
+    int32_t res = freecanard_admit_transfer(&cookie->_tx_ins, transfer);
+    if (res == 0)
+    {
+        res = freecanard_transmit_transfer(&cookie->_tx_ins, transfer);
+    }
+    const freecanard_on_tx_drained on_tx_drained =
+        res > 0 && canardTxPeek(&cookie->_tx_ins) == NULL ? cookie->_on_tx_drained : NULL;
+
+    freecanard_give_mutex(&cookie->_tx_mutex);
+
+    if (on_tx_drained != NULL)
+    {
+        on_tx_drained(ins);
+    }
+    return res;
+}
+
+void freecanard_set_loopback(CanardInstance *const ins, const bool enable)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    __atomic_store_n(&cookie->_loopback, enable, __ATOMIC_RELAXED);
+}
+
+bool freecanard_payload_cache_init(
+    freecanard_payload_cache_t *const cache,
+    const void *const source,
+    freecanard_cache_serialize serialize,
+    uint8_t *const buffer,
+    const size_t buffer_size)
+{
+    cache->_source = source;
+    cache->_serialize = serialize;
+    cache->_buffer = buffer;
+    cache->_capacity = buffer_size;
+    cache->_size = 0;
+    cache->_generation = 1;
+    cache->_cached_generation = 0;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    cache->_mutex = xSemaphoreCreateMutexStatic(&cache->_mutex_buffer);
+#else
+    cache->_mutex = xSemaphoreCreateMutex();
+#endif
+    return cache->_mutex != NULL;
+}
+
+void freecanard_payload_cache_invalidate(freecanard_payload_cache_t *const cache)
+{
+    (void)__atomic_fetch_add(&cache->_generation, 1U, __ATOMIC_RELEASE);
+}
+
+int32_t freecanard_respond_cached(
+    CanardInstance *const ins,
+    freecanard_payload_cache_t *const cache,
+    const CanardTransfer *const request)
+{
+    freecanard_take_mutex(&cache->_mutex);
+
+    // The generation is sampled before serializing, so an invalidation
+    // racing with the serialization is not lost
+    const uint32_t generation = __atomic_load_n(&cache->_generation, __ATOMIC_ACQUIRE);
+    if (generation != cache->_cached_generation)
+    {
+        size_t size = cache->_capacity;
+        const int8_t res = cache->_serialize(cache->_source, cache->_buffer, &size);
+        if (res < 0)
+        {
+            freecanard_give_mutex(&cache->_mutex);
+            return res;
+        }
+        cache->_size = size;
+        cache->_cached_generation = generation;
+    }
+
+    const CanardTransfer response = {
+        .timestamp_usec = FREECANARD_MONOTONIC_USEC(),
+        .priority = request->priority,
+        .transfer_kind = CanardTransferKindResponse,
+        .port_id = request->port_id,
+        .remote_node_id = request->remote_node_id,
+        .transfer_id = request->transfer_id,
+        .payload_size = cache->_size,
+        .payload = cache->_buffer};
+    const int32_t res = freecanard_transmit(ins, &response);
+
+    freecanard_give_mutex(&cache->_mutex);
+    return res;
+}
+
+void freecanard_set_tx_drained_callback(CanardInstance *const ins, freecanard_on_tx_drained on_tx_drained)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    freecanard_take_mutex(&cookie->_tx_mutex);
+
+    cookie->_on_tx_drained = on_tx_drained;
+
+    freecanard_give_mutex(&cookie->_tx_mutex);
+}
+
+bool freecanard_tx_queue_empty(CanardInstance *const ins)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    freecanard_take_mutex(&cookie->_tx_mutex);
+
+    const bool empty = canardTxPeek(&cookie->_tx_ins) == NULL;
+
+    freecanard_give_mutex(&cookie->_tx_mutex);
+    return empty;
+}
+
+int32_t freecanard_call(
+    CanardInstance *const ins,
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardPriority priority,
+    const void *const request_payload,
+    const size_t request_payload_size,
+    const TickType_t timeout,
+    freecanard_response_t *const response)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    // The response would never be processed
+    if (xTaskGetCurrentTaskHandle() == cookie->_processing_task)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    freecanard_call_t call = {
+        .user_reference_ = NULL,
+        ._on_response = NULL,
+        ._task = xTaskGetCurrentTaskHandle(),
+        ._response = response};
+
+    // Discard a notification left over by a call which timed out
+    (void)ulTaskNotifyTakeIndexed(FREECANARD_CALL_NOTIFICATION_INDEX, pdTRUE, 0);
+
+    const int32_t res = freecanard_start_call(
+        ins,
+        service_id,
+        server_node_id,
+        priority,
+        request_payload,
+        request_payload_size,
+        timeout,
+        &call);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    // Only the completion mark tells that the response was copied, a
+    // notification may be left over by a previous call
+    const TickType_t start = xTaskGetTickCount();
+    TickType_t remaining = timeout;
+    for (;;)
+    {
+        const bool notified = ulTaskNotifyTakeIndexed(FREECANARD_CALL_NOTIFICATION_INDEX, pdTRUE, remaining) != 0;
+        if (__atomic_load_n(&call._completed, __ATOMIC_ACQUIRE))
+        {
+            return 0;
+        }
+
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        if (!notified || (timeout != portMAX_DELAY && elapsed >= timeout))
+        {
+            break;
+        }
+        remaining = timeout == portMAX_DELAY ? portMAX_DELAY : timeout - elapsed;
+    }
+
+    taskENTER_CRITICAL();
+    const bool timed_out = freecanard_remove_call(cookie, &call);
+    taskEXIT_CRITICAL();
+    if (timed_out)
+    {
+        return -FREECANARD_ERROR_CALL_TIMEOUT;
+    }
+
+    // The response arrived in the meantime, and is being copied
+    while (!__atomic_load_n(&call._completed, __ATOMIC_ACQUIRE))
+    {
+        (void)ulTaskNotifyTakeIndexed(FREECANARD_CALL_NOTIFICATION_INDEX, pdTRUE, portMAX_DELAY);
+    }
+    return 0;
+}
+
+int32_t freecanard_call_async(
+    CanardInstance *const ins,
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardPriority priority,
+    const void *const request_payload,
+    const size_t request_payload_size,
+    const TickType_t timeout,
+    freecanard_call_t *const call,
+    freecanard_on_response on_response)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    call->_on_response = on_response;
+    call->_task = NULL;
+    call->_response = NULL;
+
+    const int32_t res = freecanard_start_call(
+        ins,
+        service_id,
+        server_node_id,
+        priority,
+        request_payload,
+        request_payload_size,
+        timeout,
+        call);
+
+    if (res < 0)
+    {
+        return res;
+    }
+
+    // The processing task may need to wake up earlier to expire the call
+    freecanard_wake_processing(cookie);
+    return 0;
+}
+
+void freecanard_process_received_frame(
+    CanardInstance *const ins,
+    const CanardFrame *const frame,
+    const uint8_t redundant_transport_index,
+    TickType_t timeout)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    freecanard_frame_t freecanard_frame;
+    canard_to_freecanard_frame(frame, &freecanard_frame);
+
+    freecanard_frame_queue_item_t queue_item = (freecanard_frame_queue_item_t){
+        .frame_ = freecanard_frame,
+        .timestamp_usec = frame->timestamp_usec,
+        .redundant_transport_index_ = redundant_transport_index};
+    xQueueSendToBack(cookie->_processing_task_queue, &queue_item, timeout);
+
+    if (cookie->_processing_task_notify)
+    {
+        freecanard_request_priority_boost(ins, cookie->_processing_task_queue, false, NULL);
+        xTaskNotifyGive(cookie->_processing_task);
+    }
+}
+
+void freecanard_process_received_frame_from_ISR(
+    CanardInstance *const ins,
+    const CanardFrame *const frame,
+    const uint8_t redundant_transport_index)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    freecanard_frame_t freecanard_frame;
+    canard_to_freecanard_frame(frame, &freecanard_frame);
+
+    BaseType_t HigherPriorityTaskWoken = pdFALSE;
+    freecanard_frame_queue_item_t queue_item = (freecanard_frame_queue_item_t){
+        .frame_ = freecanard_frame,
+        .timestamp_usec = frame->timestamp_usec,
+        .redundant_transport_index_ = redundant_transport_index};
+
+    // Per-core queues are only drained by a dedicated processing task,
+    // the reactor only waits on the first one
+    QueueHandle_t queue = cookie->_processing_task_queue;
+#if FREECANARD_NUM_CORES > 1
+    const UBaseType_t core = FREECANARD_CORE_ID();
+    if (cookie->_processing_task_notify && core > 0)
+    {
+        queue = cookie->_rx_core_queues[core - 1];
+    }
+#endif
+
+    const BaseType_t enqueued = xQueueSendToBackFromISR(
+        queue,
+        &queue_item,
+        &HigherPriorityTaskWoken);
+
+    if (cookie->_processing_task_notify)
+    {
+        freecanard_request_priority_boost(ins, queue, true, &HigherPriorityTaskWoken);
+    }
+    if (cookie->_processing_task_notify &&
+        freecanard_rx_coalesce_from_ISR(cookie, enqueued == pdTRUE, &HigherPriorityTaskWoken))
+    {
+        vTaskNotifyGiveFromISR(cookie->_processing_task, &HigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(HigherPriorityTaskWoken);
+}
+
+size_t freecanard_poll(CanardInstance *const ins, const size_t max_frames, const uint32_t budget_usec)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    // Polling a bus serviced by a task would reorder its frames
+    if (cookie->_processing_task != NULL)
+    {
+        return 0;
+    }
+
+    freecanard_take_mutex(&cookie->_tx_mutex);
+    const bool sent = freecanard_flush_tx_queue(&cookie->_tx_ins);
+    const freecanard_on_tx_drained on_tx_drained =
+        sent && canardTxPeek(&cookie->_tx_ins) == NULL ? cookie->_on_tx_drained : NULL;
+    freecanard_give_mutex(&cookie->_tx_mutex);
+
+    if (on_tx_drained != NULL)
+    {
+        on_tx_drained(ins);
+    }
+
+    const uint64_t start_usec = FREECANARD_MONOTONIC_USEC();
+    freecanard_frame_queue_item_t queue_item;
+    size_t processed = 0;
+    while (processed < max_frames &&
+           xQueueReceive(cookie->_processing_task_queue, &queue_item, 0) == pdTRUE)
+    {
+        freecanard_process_queue_item(ins, &queue_item);
+        processed++;
+
+        if (budget_usec != UINT32_MAX && (FREECANARD_MONOTONIC_USEC() - start_usec) >= budget_usec)
+        {
+            break;
+        }
+    }
+
+    freecanard_expire_calls(ins);
+    freecanard_run_rx_session_eviction(ins);
+    return processed;
+}
+
+static void freecanard_processing_task(void *canard_instance)
+{
+    CanardInstance *ins = (CanardInstance *)canard_instance;
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    while (1)
+    {
+        // Block until new frames are received, or the next periodic job is due
+        ulTaskNotifyTake(pdTRUE, freecanard_processing_timeout(cookie));
+
+        freecanard_apply_rx_updates(ins);
+#if (configUSE_TIMERS == 1)
+        // Everything enqueued so far is about to be processed
+        taskENTER_CRITICAL();
+        cookie->_rx_coalesce_pending = 0;
+        taskEXIT_CRITICAL();
+#endif
+        freecanard_drain_rx_queues(ins);
+        freecanard_end_priority_boost(ins);
+        freecanard_expire_calls(ins);
+        freecanard_run_rx_session_eviction(ins);
+    }
+}
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+static void freecanard_worker_task(void *worker_queue)
+{
+    QueueHandle_t queue = (QueueHandle_t)worker_queue;
+    freecanard_work_item_t work_item;
+
+    while (1)
+    {
+        if (xQueueReceive(queue, &work_item, portMAX_DELAY) == pdTRUE)
+        {
+            freecanard_deliver_transfer(work_item.ins, &work_item.transfer);
+        }
+    }
+}
+#endif
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1) && (configUSE_QUEUE_SETS == 1)
+bool freecanard_reactor_init(
+    freecanard_reactor_t *const reactor,
+    const UBaseType_t task_priority,
+    const configSTACK_DEPTH_TYPE task_stack_size,
+    const UBaseType_t queue_set_size)
+{
+    reactor->_queue_set = xQueueCreateSet(queue_set_size);
+    reactor->_wakeup = xSemaphoreCreateBinary();
+    reactor->_bus_count = 0;
+    reactor->_cursor = 0;
+    reactor->_task = NULL;
+
+    const bool in_set = reactor->_queue_set != NULL &&
+                        reactor->_wakeup != NULL &&
+                        xQueueAddToSet(reactor->_wakeup, reactor->_queue_set) == pdPASS;
+    if (in_set &&
+        xTaskCreate(
+            freecanard_reactor_task,
+            "FreecanardReactorTask",
+            task_stack_size,
+            (void *)reactor,
+            task_priority,
+            &reactor->_task) == pdPASS)
+    {
+        return true;
+    }
+
+    reactor->_task = NULL;
+    if (in_set)
+    {
+        (void)xQueueRemoveFromSet(reactor->_wakeup, reactor->_queue_set);
+    }
+    if (reactor->_wakeup != NULL)
+    {
+        vSemaphoreDelete(reactor->_wakeup);
+        reactor->_wakeup = NULL;
+    }
+    if (reactor->_queue_set != NULL)
+    {
+        vQueueDelete(reactor->_queue_set);
+        reactor->_queue_set = NULL;
+    }
+    return false;
+}
+
+bool freecanard_reactor_attach(
+    freecanard_reactor_t *const reactor,
+    CanardInstance *const ins,
+    const UBaseType_t weight)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    bool attached = false;
+
+    if (weight == 0)
+    {
+        return false;
+    }
+
+    // The reactor task may run on another core, and reads the bus list
+    // without locking: the slot is filled before the count is published
+    taskENTER_CRITICAL();
+    const size_t bus_count = reactor->_bus_count;
+    if (bus_count < FREECANARD_REACTOR_MAX_BUSES &&
+        cookie->_processing_task == NULL &&
+        xQueueAddToSet(cookie->_processing_task_queue, reactor->_queue_set) == pdPASS)
+    {
+        reactor->_buses[bus_count] = ins;
+        reactor->_weights[bus_count] = weight;
+        reactor->_credits[bus_count] = weight;
+        reactor->_pending[bus_count] = 0;
+        cookie->_processing_task = reactor->_task;
+        cookie->_processing_wakeup = reactor->_wakeup;
+        __atomic_store_n(&reactor->_bus_count, bus_count + 1U, __ATOMIC_RELEASE);
+        attached = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return attached;
+}
+
+static void freecanard_reactor_task(void *reactor_handle)
+{
+    freecanard_reactor_t *reactor = (freecanard_reactor_t *)reactor_handle;
+
+    while (1)
+    {
+        const size_t bus_count = __atomic_load_n(&reactor->_bus_count, __ATOMIC_ACQUIRE);
+
+        // Frames whose events were taken already are processed without waiting
+        bool pending = false;
+        TickType_t timeout = portMAX_DELAY;
+        for (size_t i = 0; i < bus_count; i++)
+        {
+            const TickType_t bus_timeout =
+                freecanard_processing_timeout((freecanard_cookie_t *)reactor->_buses[i]->user_reference);
+            timeout = bus_timeout < timeout ? bus_timeout : timeout;
+            pending = pending || reactor->_pending[i] > 0;
+        }
+
+        // Block until a frame is received on any bus, or the next periodic
+        // job is due. Every event of the set is then taken, so that the
+        // buses with frames waiting are all known when picking the next one.
+        QueueSetMemberHandle_t member;
+        while ((member = xQueueSelectFromSet(reactor->_queue_set, pending ? 0 : timeout)) != NULL)
+        {
+            pending = true;
+            if (member == reactor->_wakeup)
+            {
+                (void)xSemaphoreTake(reactor->_wakeup, 0);
+                continue;
+            }
+            reactor->_pending[freecanard_reactor_find_bus(reactor, member)]++;
+        }
+
+        // Subscription changes of any bus
+        for (size_t i = 0; i < bus_count; i++)
+        {
+            freecanard_apply_rx_updates(reactor->_buses[i]);
+        }
+
+        freecanard_reactor_service(reactor, __atomic_load_n(&reactor->_bus_count, __ATOMIC_ACQUIRE));
+
+        for (size_t i = 0; i < bus_count; i++)
+        {
+            freecanard_expire_calls(reactor->_buses[i]);
+            freecanard_run_rx_session_eviction(reactor->_buses[i]);
+        }
+    }
+}
+
+/**
+ * Find the bus whose processing queue is a member of the queue set of a
+ * reactor. A bus being attached on another core may signal its first frame
+ * before it is published, in which case the lookup is repeated until it is.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static size_t freecanard_reactor_find_bus(const freecanard_reactor_t *const reactor, QueueSetMemberHandle_t member)
+{
+    for (;;)
+    {
+        const size_t bus_count = __atomic_load_n(&reactor->_bus_count, __ATOMIC_ACQUIRE);
+        for (size_t i = 0; i < bus_count; i++)
+        {
+            const freecanard_cookie_t *cookie = (const freecanard_cookie_t *)reactor->_buses[i]->user_reference;
+            if (cookie->_processing_task_queue == member)
+            {
+                return i;
+            }
+        }
+    }
+}
+
+/**
+ * Process one frame of the next bus in a weighted round robin over the buses
+ * with frames waiting. A bus is processed until it used up its credits, and
+ * the credits of all buses are restored once no bus with frames waiting has
+ * any left.
+ *
+ * The queue set holds one event per frame, which was taken already, so
+ * exactly one frame is received per event, or the set could overflow.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_reactor_service(freecanard_reactor_t *const reactor, const size_t bus_count)
+{
+    for (size_t pass = 0; pass < 2U; pass++)
+    {
+        for (size_t n = 0; n < bus_count; n++)
+        {
+            const size_t i = (reactor->_cursor + n) % bus_count;
+            if (reactor->_pending[i] == 0 || reactor->_credits[i] == 0)
+            {
+                continue;
+            }
+
+            CanardInstance *ins = reactor->_buses[i];
+            freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+            freecanard_frame_queue_item_t queue_item;
+            reactor->_pending[i]--;
+            reactor->_credits[i]--;
+            reactor->_cursor = reactor->_credits[i] > 0 ? i : (i + 1U) % bus_count;
+            if (xQueueReceive(cookie->_processing_task_queue, &queue_item, 0) == pdTRUE)
+            {
+                freecanard_process_queue_item(ins, &queue_item);
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < bus_count; i++)
+        {
+            reactor->_credits[i] = reactor->_weights[i];
+        }
+    }
+}
+#endif
+
+/* Private helper functions */
+
+/**
+ * Add, replace or remove a streaming subscription.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static int8_t freecanard_apply_stream_update(freecanard_cookie_t *const cookie, const freecanard_rx_update_t *const update)
+{
+    freecanard_stream_t **link = &cookie->_streams;
+    while (*link != NULL &&
+           ((*link)->_transfer_kind != update->transfer_kind || (*link)->_port_id != update->port_id))
+    {
+        link = &(*link)->_next;
+    }
+    freecanard_stream_t *const existing = *link;
+
+    if (!update->subscribe)
+    {
+        if (existing == NULL)
+        {
+            return 0;
+        }
+        __atomic_store_n(link, existing->_next, __ATOMIC_RELAXED);
+        return 1;
+    }
+
+    freecanard_stream_t *const stream = update->stream;
+    stream->_transfer_kind = update->transfer_kind;
+    stream->_port_id = update->port_id;
+    stream->_transfer_id_timeout_usec = update->transfer_id_timeout_usec;
+    stream->_on_stream = update->on_stream;
+    stream->_active = false;
+    stream->_holdback_size = 0;
+    stream->_last_source_node_id = CANARD_NODE_ID_UNSET;
+    stream->_last_transfer_id = 0;
+    stream->_last_timestamp_usec = 0;
+
+    if (existing != NULL)
+    {
+        stream->_next = existing->_next;
+        __atomic_store_n(link, stream, __ATOMIC_RELAXED);
+        return 0;
+    }
+    stream->_next = cookie->_streams;
+    __atomic_store_n(&cookie->_streams, stream, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ * Feed a frame to the streaming subscription of its port, if any.
+ *
+ * @return true if the frame belongs to a streaming subscription, and must
+ * not be fed to libcanard.
+ */
+static bool freecanard_accept_stream_frame(CanardInstance *const ins, const freecanard_frame_queue_item_t *const queue_item)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    const freecanard_frame_t *const frame = &queue_item->frame_;
+
+    // Anonymous messages are single-frame, leave them to libcanard
+    const uint32_t can_id = frame->id;
+    const bool service = (can_id & (1UL << 25U)) != 0U;
+    if (__atomic_load_n(&cookie->_streams, __ATOMIC_RELAXED) == NULL ||
+        frame->data_len == 0 ||
+        (!service && (can_id & (1UL << 24U)) != 0U))
+    {
+        return false;
+    }
+
+    CanardTransferKind transfer_kind;
+    const CanardPortID port_id = freecanard_parse_port(can_id, &transfer_kind);
+
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    freecanard_stream_t *stream = cookie->_streams;
+    while (stream != NULL && (stream->_transfer_kind != transfer_kind || stream->_port_id != port_id))
+    {
+        stream = stream->_next;
+    }
+    const CanardNodeID local_node_id = ins->node_id;
+    freecanard_give_mutex(&cookie->_rx_mutex);
+
+    if (stream == NULL)
+    {
+        return false;
+    }
+
+    // Services addressed to other nodes are dropped, as libcanard would
+    if (!service || (CanardNodeID)((can_id >> 7U) & CANARD_NODE_ID_MAX) == local_node_id)
+    {
+        freecanard_stream_frame(ins, stream, queue_item, (CanardNodeID)(can_id & CANARD_NODE_ID_MAX));
+    }
+    return true;
+}
+
+/**
+ * Advance the transfer of a streaming subscription with a frame, and emit the
+ * resulting events. The frame is validated as libcanard would, and the last
+ * two bytes received are held back, as they may turn out to be the CRC.
+ *
+ * Note: This function is NOT thread safe, and is only executed by the task
+ * processing the bus.
+ */
+static void freecanard_stream_frame(
+    CanardInstance *const ins,
+    freecanard_stream_t *const stream,
+    const freecanard_frame_queue_item_t *const queue_item,
+    const CanardNodeID source_node_id)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    const freecanard_frame_t *const frame = &queue_item->frame_;
+    const CanardMicrosecond now_usec = queue_item->timestamp_usec;
+
+    const uint8_t tail = frame->data[frame->data_len - 1U];
+    const bool start = (tail & 0x80U) != 0U;
+    const bool end = (tail & 0x40U) != 0U;
+    const bool toggle = (tail & 0x20U) != 0U;
+    const CanardTransferID transfer_id = (CanardTransferID)(tail & CANARD_TRANSFER_ID_MAX);
+    const size_t size = frame->data_len - 1U;
+
+    if (start)
+    {
+        if (!toggle)
+        {
+            return;
+        }
+
+        if (stream->_active)
+        {
+            // Frames of redundant interfaces, or of another node while the
+            // current transfer is still fresh
+            const bool timed_out = now_usec - stream->_timestamp_usec > stream->_transfer_id_timeout_usec;
+            if ((source_node_id == stream->_source_node_id && transfer_id == stream->_transfer_id) ||
+                (source_node_id != stream->_source_node_id && !timed_out))
+            {
+                return;
+            }
+            stream->_active = false;
+            FREECANARD_STATS_ADD(cookie, rx_stream_aborts, 1);
+            freecanard_stream_emit(ins, stream, FREECANARD_STREAM_ABORT, NULL, 0, stream->_offset);
+        }
+        else if (source_node_id == stream->_last_source_node_id &&
+                 transfer_id == stream->_last_transfer_id &&
+                 now_usec - stream->_last_timestamp_usec <= stream->_transfer_id_timeout_usec)
+        {
+            return;
+        }
+
+        stream->_active = true;
+        stream->_toggle = true;
+        stream->_priority = (CanardPriority)((frame->id >> 26U) & 7U);
+        stream->_source_node_id = source_node_id;
+        stream->_transfer_id = transfer_id;
+        stream->_redundant_transport_index = queue_item->redundant_transport_index_;
+        stream->_timestamp_usec = now_usec;
+        stream->_crc = 0xFFFFU;
+        stream->_offset = 0;
+        stream->_holdback_size = 0;
+    }
+    else if (!stream->_active ||
+             source_node_id != stream->_source_node_id ||
+             transfer_id != stream->_transfer_id ||
+             queue_item->redundant_transport_index_ != stream->_redundant_transport_index)
+    {
+        return;
+    }
+
+    // A repeated toggle is a duplicated frame
+    if (toggle != stream->_toggle)
+    {
+        return;
+    }
+    stream->_toggle = !toggle;
+
+    if (end)
+    {
+        stream->_active = false;
+        stream->_last_source_node_id = source_node_id;
+        stream->_last_transfer_id = transfer_id;
+        stream->_last_timestamp_usec = stream->_timestamp_usec;
+    }
+
+    // Single-frame transfers carry no CRC
+    if (start && end)
+    {
+        if (size > 0)
+        {
+            freecanard_stream_emit(ins, stream, FREECANARD_STREAM_CHUNK, frame->data, size, 0);
+        }
+        freecanard_stream_emit(ins, stream, FREECANARD_STREAM_END, NULL, 0, size);
+        return;
+    }
+
+    stream->_crc = freecanard_crc_add(stream->_crc, frame->data, size);
+    memcpy(&stream->_chunk[stream->_holdback_size], frame->data, size);
+    const size_t available = stream->_holdback_size + size;
+    const size_t deliverable = available > 2U ? available - 2U : 0U;
+
+    if (end && (stream->_crc != 0U || available < 2U))
+    {
+        FREECANARD_STATS_ADD(cookie, rx_stream_aborts, 1);
+        freecanard_stream_emit(ins, stream, FREECANARD_STREAM_ABORT, NULL, 0, stream->_offset);
+        return;
+    }
+
+    if (deliverable > 0)
+    {
+        freecanard_stream_emit(ins, stream, FREECANARD_STREAM_CHUNK, stream->_chunk, deliverable, stream->_offset);
+        stream->_offset += deliverable;
+    }
+
+    if (end)
+    {
+        freecanard_stream_emit(ins, stream, FREECANARD_STREAM_END, NULL, 0, stream->_offset);
+        return;
+    }
+
+    memmove(stream->_chunk, &stream->_chunk[deliverable], available - deliverable);
+    stream->_holdback_size = available - deliverable;
+}
+
+static void freecanard_stream_emit(
+    CanardInstance *const ins,
+    freecanard_stream_t *const stream,
+    const freecanard_stream_event_t event,
+    const uint8_t *const payload,
+    const size_t payload_size,
+    const size_t offset)
+{
+    const CanardTransfer chunk = {
+        .timestamp_usec = stream->_timestamp_usec,
+        .priority = stream->_priority,
+        .transfer_kind = stream->_transfer_kind,
+        .port_id = stream->_port_id,
+        .remote_node_id = stream->_source_node_id,
+        .transfer_id = stream->_transfer_id,
+        .payload_size = payload_size,
+        .payload = payload};
+    stream->_on_stream(ins, stream, event, &chunk, offset);
+}
+
+/**
+ * CRC-16-CCITT-FALSE, as used by multi-frame UAVCAN/CAN transfers. Running
+ * it over the payload followed by its big-endian CRC yields zero.
+ */
+static uint16_t freecanard_crc_add(uint16_t crc, const uint8_t *data, size_t size)
+{
+    while (size-- > 0)
+    {
+        crc ^= (uint16_t)((uint16_t)*data++ << 8U);
+        for (uint8_t bit = 0; bit < 8U; bit++)
+        {
+            crc = (crc & 0x8000U) != 0U ? (uint16_t)((uint16_t)(crc << 1U) ^ 0x1021U) : (uint16_t)(crc << 1U);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Extract the transfer kind and the port of a frame from its CAN ID, as
+ * specified by the UAVCAN/CAN transport.
+ */
+static CanardPortID freecanard_parse_port(const uint32_t can_id, CanardTransferKind *const out_transfer_kind)
+{
+    if ((can_id & (1UL << 25U)) != 0U)
+    {
+        *out_transfer_kind = (can_id & (1UL << 24U)) != 0U ? CanardTransferKindRequest : CanardTransferKindResponse;
+        return (CanardPortID)((can_id >> 14U) & CANARD_SERVICE_ID_MAX);
+    }
+    *out_transfer_kind = CanardTransferKindMessage;
+    return (CanardPortID)((can_id >> 8U) & CANARD_SUBJECT_ID_MAX);
+}
+
+/**
+ * Check whether the port of a frame, given its CAN ID, is accepted by a port
+ * filter.
+ */
+static bool freecanard_port_filter_accepts(const freecanard_port_filter_t *const filter, const uint32_t can_id)
+{
+    CanardTransferKind transfer_kind;
+    const CanardPortID port_id = freecanard_parse_port(can_id, &transfer_kind);
+
+    const uint32_t *const bitmap = filter->ports[transfer_kind];
+    return bitmap != NULL && ((bitmap[port_id / 32U] >> (port_id % 32U)) & 1U) != 0U;
+}
+
+/**
+ * Feed a received frame to libcanard, and deliver the transfer it completes,
+ * if any, to the application.
+ */
+static void freecanard_process_queue_item(CanardInstance *const ins, const freecanard_frame_queue_item_t *const queue_item)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    const freecanard_port_filter_t *filter = __atomic_load_n(&cookie->_rx_port_filter, __ATOMIC_ACQUIRE);
+    if (filter != NULL && !freecanard_port_filter_accepts(filter, queue_item->frame_.id))
+    {
+        FREECANARD_STATS_ADD(cookie, rx_frames_filtered, 1);
+        return;
+    }
+
+    if (freecanard_accept_stream_frame(ins, queue_item))
+    {
+        return;
+    }
+
+    CanardFrame canard_frame;
+    freecanard_to_canard_frame(&queue_item->frame_, &canard_frame);
+    canard_frame.timestamp_usec = queue_item->timestamp_usec;
+
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    cookie->_rx_last_timestamp_usec = queue_item->timestamp_usec;
+    cookie->_rx_last_tick = xTaskGetTickCount();
+
+    if (cookie->_rx_into_providers != NULL)
+    {
+        CanardTransferKind transfer_kind;
+        const CanardPortID port_id = freecanard_parse_port(queue_item->frame_.id, &transfer_kind);
+        freecanard_set_rx_into_hint(ins, &queue_item->frame_, transfer_kind, port_id);
+    }
+
+    CanardTransfer transfer;
+    int8_t res = canardRxAccept(
+        ins,
+        &canard_frame,
+        queue_item->redundant_transport_index_,
+        &transfer);
+    cookie->_rx_into_hint = NULL;
+
+    // Sampled and queued transfers are done with once copied into their
+    // mailbox or queue
+    if (res == 1 &&
+        (freecanard_deliver_sample(cookie, &transfer) || freecanard_deliver_queued(cookie, &transfer)))
+    {
+        freecanard_release_rx_payload(ins, &transfer);
+        res = 0;
+    }
+    freecanard_give_mutex(&cookie->_rx_mutex);
+
+    if (res == 1)
+    {
+        if (transfer.transfer_kind == CanardTransferKindResponse && freecanard_complete_call(ins, &transfer))
+        {
+            return;
+        }
+
+        if (cookie->_worker_count == 0)
+        {
+            freecanard_deliver_transfer(ins, &transfer);
+            return;
+        }
+
+        // Transfers of the same port always go to the same worker to preserve
+        // their order
+        const freecanard_work_item_t work_item = {.ins = ins, .transfer = transfer};
+        const UBaseType_t worker =
+            ((UBaseType_t)transfer.port_id * CANARD_NUM_TRANSFER_KINDS + (UBaseType_t)transfer.transfer_kind) %
+            cookie->_worker_count;
+
+        if (xQueueSendToBack(cookie->_worker_queues[worker], &work_item, 0) != pdTRUE)
+        {
+            freecanard_take_mutex(&cookie->_rx_mutex);
+            FREECANARD_STATS_ADD(cookie, rx_worker_queue_overflows, 1);
+            freecanard_release_rx_payload(ins, &transfer);
+            freecanard_give_mutex(&cookie->_rx_mutex);
+        }
+    }
+}
+
+/**
+ * Process the frames waiting in the ingestion queues of all cores.
+ *
+ * At most the frames already waiting when the function is called are
+ * processed, so the periodic jobs are never starved. Frames arriving later
+ * leave a pending notification to the processing task.
+ */
+static void freecanard_drain_rx_queues(CanardInstance *const ins)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    QueueHandle_t queues[FREECANARD_NUM_CORES];
+    UBaseType_t waiting[FREECANARD_NUM_CORES];
+    queues[0] = cookie->_processing_task_queue;
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 1; core < FREECANARD_NUM_CORES; core++)
+    {
+        queues[core] = cookie->_rx_core_queues[core - 1];
+    }
+#endif
+
+    UBaseType_t remaining = 0;
+    for (size_t core = 0; core < FREECANARD_NUM_CORES; core++)
+    {
+        waiting[core] = uxQueueMessagesWaiting(queues[core]);
+        remaining += waiting[core];
+    }
+
+    // Interleave the cores, frames of different interfaces are independent
+    freecanard_frame_queue_item_t queue_item;
+    while (remaining > 0)
+    {
+        for (size_t core = 0; core < FREECANARD_NUM_CORES; core++)
+        {
+            if (waiting[core] == 0)
+            {
+                continue;
+            }
+            waiting[core]--;
+            remaining--;
+
+            if (xQueueReceive(queues[core], &queue_item, 0) == pdTRUE)
+            {
+                freecanard_process_queue_item(ins, &queue_item);
+            }
+        }
+    }
+}
+
+/**
+ * Account for a frame enqueued from an ISR, and decide whether the processing
+ * task shall be woken right away, see freecanard_set_rx_coalescing. Starts
+ * the latency timer on the first pending frame.
+ *
+ * @return true if the processing task shall be notified.
+ */
+static bool freecanard_rx_coalesce_from_ISR(
+    freecanard_cookie_t *const cookie,
+    const bool enqueued,
+    BaseType_t *const higher_priority_task_woken)
+{
+#if (configUSE_TIMERS == 1)
+    bool notify = true;
+    bool start_timer = false;
+
+    const UBaseType_t saved_interrupt_status = taskENTER_CRITICAL_FROM_ISR();
+    if (cookie->_rx_coalesce_frames > 1)
+    {
+        // A full queue is processed right away, whatever the threshold
+        if (enqueued && ++cookie->_rx_coalesce_pending < cookie->_rx_coalesce_frames)
+        {
+            notify = false;
+            start_timer = cookie->_rx_coalesce_pending == 1;
+        }
+        else
+        {
+            cookie->_rx_coalesce_pending = 0;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved_interrupt_status);
+
+    // Never leave frames pending without a timer bounding their latency
+    if (start_timer && xTimerStartFromISR(cookie->_rx_coalesce_timer, higher_priority_task_woken) != pdPASS)
+    {
+        notify = true;
+    }
+    return notify;
+#else
+    (void)cookie;
+    (void)enqueued;
+    (void)higher_priority_task_woken;
+    return true;
+#endif
+}
+
+#if (configUSE_TIMERS == 1)
+/**
+ * Wake the processing task once the latency bound of the pending frames
+ * expires. Executed by the timer service task.
+ */
+static void freecanard_rx_coalesce_timer_callback(TimerHandle_t timer)
+{
+    CanardInstance *ins = (CanardInstance *)pvTimerGetTimerID(timer);
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    // The frames may have been processed already, e.g. when the threshold
+    // was reached in the meantime
+    taskENTER_CRITICAL();
+    const bool pending = cookie->_rx_coalesce_pending != 0;
+    cookie->_rx_coalesce_pending = 0;
+    taskEXIT_CRITICAL();
+
+    if (pending)
+    {
+        xTaskNotifyGive(cookie->_processing_task);
+    }
+}
+#endif
+
+/**
+ * Request a priority boost of the processing task if @p queue, into which a
+ * frame was just enqueued, reached the high watermark. From an ISR, the
+ * boost is deferred to the timer service task.
+ */
+static void freecanard_request_priority_boost(
+    CanardInstance *const ins,
+    QueueHandle_t queue,
+    const bool from_ISR,
+    BaseType_t *const higher_priority_task_woken)
+{
+#if FREECANARD_PRIORITY_BOOST
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    bool request = false;
+
+    if (from_ISR)
+    {
+        const UBaseType_t saved_interrupt_status = taskENTER_CRITICAL_FROM_ISR();
+        if (cookie->_boost_high_watermark != 0 &&
+            cookie->_boost_state == FREECANARD_BOOST_IDLE &&
+            uxQueueMessagesWaitingFromISR(queue) >= cookie->_boost_high_watermark)
+        {
+            cookie->_boost_state = FREECANARD_BOOST_REQUESTED;
+            request = true;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(saved_interrupt_status);
+
+        if (request &&
+            xTimerPendFunctionCallFromISR(
+                freecanard_apply_priority_boost,
+                (void *)ins,
+                0,
+                higher_priority_task_woken) != pdPASS)
+        {
+            // The timer command queue is full, retry with the next frame
+            const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+            cookie->_boost_state = FREECANARD_BOOST_IDLE;
+            taskEXIT_CRITICAL_FROM_ISR(saved);
+        }
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (cookie->_boost_high_watermark != 0 &&
+        cookie->_boost_state == FREECANARD_BOOST_IDLE &&
+        uxQueueMessagesWaiting(queue) >= cookie->_boost_high_watermark)
+    {
+        cookie->_boost_state = FREECANARD_BOOST_REQUESTED;
+        request = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (request)
+    {
+        freecanard_apply_priority_boost((void *)ins, 0);
+    }
+#else
+    (void)ins;
+    (void)queue;
+    (void)from_ISR;
+    (void)higher_priority_task_woken;
+#endif
+}
+
+/**
+ * Drop the processing task back to its own priority once its queues are
+ * drained down to the low watermark. Called by the processing task.
+ */
+static void freecanard_end_priority_boost(CanardInstance *const ins)
+{
+#if FREECANARD_PRIORITY_BOOST
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (cookie->_boost_high_watermark == 0)
+    {
+        return;
+    }
+
+    const UBaseType_t waiting = freecanard_rx_queue_occupancy(cookie);
+    bool was_active = false;
+
+    taskENTER_CRITICAL();
+    if (cookie->_boost_state != FREECANARD_BOOST_IDLE && waiting <= cookie->_boost_low_watermark)
+    {
+        // A boost still pending in the timer service task is cancelled
+        was_active = cookie->_boost_state == FREECANARD_BOOST_ACTIVE;
+        if (was_active)
+        {
+            freecanard_record_priority_boost(cookie);
+        }
+        cookie->_boost_state = FREECANARD_BOOST_IDLE;
+        cookie->_boost_generation++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (was_active)
+    {
+        freecanard_sync_boost_priority(cookie);
+    }
+#else
+    (void)ins;
+#endif
+}
+
+#if FREECANARD_PRIORITY_BOOST
+/**
+ * Raise the processing task to the boost priority, unless the request was
+ * cancelled in the meantime. Runs in the timer service task for requests
+ * originating from an ISR.
+ */
+static void freecanard_apply_priority_boost(void *canard_instance, uint32_t unused)
+{
+    CanardInstance *ins = (CanardInstance *)canard_instance;
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    bool activated = false;
+    (void)unused;
+
+    taskENTER_CRITICAL();
+    if (cookie->_boost_state == FREECANARD_BOOST_REQUESTED)
+    {
+        cookie->_boost_state = FREECANARD_BOOST_ACTIVE;
+        cookie->_boost_generation++;
+        cookie->_boost_start_tick = xTaskGetTickCount();
+        FREECANARD_STATS_ADD(cookie, processing_priority_boosts, 1);
+        activated = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (activated)
+    {
+        freecanard_sync_boost_priority(cookie);
+    }
+}
+
+/**
+ * Set the priority of the processing task to match the boost state. The
+ * priority is changed outside the critical section, so a concurrent state
+ * change may overtake it; every state change bumps the generation, and the
+ * priority is set again until it was set for the state that is current.
+ */
+static void freecanard_sync_boost_priority(freecanard_cookie_t *const cookie)
+{
+    for (;;)
+    {
+        taskENTER_CRITICAL();
+        const uint32_t generation = cookie->_boost_generation;
+        const UBaseType_t priority = cookie->_boost_state == FREECANARD_BOOST_ACTIVE
+                                         ? cookie->_boost_priority
+                                         : cookie->_processing_task_priority;
+        taskEXIT_CRITICAL();
+
+        vTaskPrioritySet(cookie->_processing_task, priority);
+
+        taskENTER_CRITICAL();
+        const bool settled = generation == cookie->_boost_generation;
+        taskEXIT_CRITICAL();
+        if (settled)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Account for the duration of the boost which just ended.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_record_priority_boost(freecanard_cookie_t *const cookie)
+{
+    const uint32_t elapsed = (uint32_t)(xTaskGetTickCount() - cookie->_boost_start_tick);
+
+    FREECANARD_STATS_ADD(cookie, processing_priority_boost_ticks, elapsed);
+    if (elapsed > FREECANARD_STATS_LOAD(cookie, processing_priority_boost_max_ticks))
+    {
+        FREECANARD_STATS_STORE(cookie, processing_priority_boost_max_ticks, elapsed);
+    }
+}
+
+/**
+ * Number of frames waiting in the ingestion queues of all cores.
+ */
+static UBaseType_t freecanard_rx_queue_occupancy(const freecanard_cookie_t *const cookie)
+{
+    UBaseType_t waiting = uxQueueMessagesWaiting(cookie->_processing_task_queue);
+#if FREECANARD_NUM_CORES > 1
+    for (size_t core = 0; core < FREECANARD_NUM_CORES - 1; core++)
+    {
+        waiting += uxQueueMessagesWaiting(cookie->_rx_core_queues[core]);
+    }
+#endif
+    return waiting;
+}
+#endif
+
+/**
+ * Register a call in the table of outstanding calls, and send its request.
+ *
+ * @return Result of freecanard_transmit, or -FREECANARD_ERROR_CALL_BUSY.
+ */
+static int32_t freecanard_start_call(
+    CanardInstance *const ins,
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardPriority priority,
+    const void *const request_payload,
+    const size_t request_payload_size,
+    const TickType_t timeout,
+    freecanard_call_t *const call)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    call->_service_id = service_id;
+    call->_server_node_id = server_node_id;
+    call->_start_tick = xTaskGetTickCount();
+    call->_timeout = timeout;
+    call->_completed = false;
+
+    // Registered before the request is sent, as the response may arrive
+    // before freecanard_transmit returns
+    int32_t res = 0;
+    taskENTER_CRITICAL();
+    call->_transfer_id = cookie->_call_transfer_id;
+    cookie->_call_transfer_id = (CanardTransferID)((cookie->_call_transfer_id + 1U) & CANARD_TRANSFER_ID_MAX);
+
+    const size_t bucket = freecanard_call_bucket(service_id, server_node_id, call->_transfer_id);
+    for (const freecanard_call_t *other = cookie->_calls[bucket]; other != NULL; other = other->_next)
+    {
+        if (other->_service_id == service_id &&
+            other->_server_node_id == server_node_id &&
+            other->_transfer_id == call->_transfer_id)
+        {
+            res = -FREECANARD_ERROR_CALL_BUSY;
+            break;
+        }
+    }
+    if (res == 0)
+    {
+        call->_next = cookie->_calls[bucket];
+        cookie->_calls[bucket] = call;
+        if (call->_on_response != NULL)
+        {
+            cookie->_calls_async_pending++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (res < 0)
+    {
+        return res;
+    }
+
+    const CanardTransfer transfer = {
+        .timestamp_usec = FREECANARD_MONOTONIC_USEC(),
+        .priority = priority,
+        .transfer_kind = CanardTransferKindRequest,
+        .port_id = service_id,
+        .remote_node_id = server_node_id,
+        .transfer_id = call->_transfer_id,
+        .payload_size = request_payload_size,
+        .payload = request_payload};
+    res = freecanard_transmit(ins, &transfer);
+    if (res < 0)
+    {
+        taskENTER_CRITICAL();
+        (void)freecanard_remove_call(cookie, call);
+        taskEXIT_CRITICAL();
+    }
+    return res;
+}
+
+static size_t freecanard_call_bucket(
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardTransferID transfer_id)
+{
+    const uint32_t key = ((uint32_t)service_id << 12U) | ((uint32_t)server_node_id << 5U) | (uint32_t)transfer_id;
+    return (size_t)((key * 2654435761UL) >> 16U) & (FREECANARD_CALL_TABLE_SIZE - 1U);
+}
+
+/**
+ * Remove a call from the table of outstanding calls.
+ *
+ * Note: This function is NOT thread safe.
+ *
+ * @return true if the call was still outstanding.
+ */
+static bool freecanard_remove_call(freecanard_cookie_t *const cookie, const freecanard_call_t *const call)
+{
+    const size_t bucket = freecanard_call_bucket(call->_service_id, call->_server_node_id, call->_transfer_id);
+    for (freecanard_call_t **link = &cookie->_calls[bucket]; *link != NULL; link = &(*link)->_next)
+    {
+        if (*link == call)
+        {
+            *link = call->_next;
+            if (call->_on_response != NULL)
+            {
+                cookie->_calls_async_pending--;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Complete the outstanding call matching a received response, if any, and
+ * release the response payload.
+ *
+ * @return true if the response was consumed by a call.
+ */
+static bool freecanard_complete_call(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    const size_t bucket = freecanard_call_bucket(transfer->port_id, transfer->remote_node_id, transfer->transfer_id);
+
+    freecanard_call_t *call = NULL;
+    taskENTER_CRITICAL();
+    for (freecanard_call_t *candidate = cookie->_calls[bucket]; candidate != NULL; candidate = candidate->_next)
+    {
+        if (candidate->_service_id == transfer->port_id &&
+            candidate->_server_node_id == transfer->remote_node_id &&
+            candidate->_transfer_id == transfer->transfer_id)
+        {
+            call = candidate;
+            (void)freecanard_remove_call(cookie, call);
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (call == NULL)
+    {
+        return false;
+    }
+
+    if (call->_on_response != NULL)
+    {
+        call->_on_response(ins, call, transfer);
+    }
+    else
+    {
+        freecanard_response_t *response = call->_response;
+        response->payload_size =
+            transfer->payload_size < response->payload_capacity ? transfer->payload_size : response->payload_capacity;
+        memcpy(response->payload, transfer->payload, response->payload_size);
+        response->timestamp_usec = transfer->timestamp_usec;
+
+        // The call may return, and its record go away, as soon as it is
+        // marked completed
+        TaskHandle_t task = call->_task;
+        __atomic_store_n(&call->_completed, true, __ATOMIC_RELEASE);
+        xTaskNotifyGiveIndexed(task, FREECANARD_CALL_NOTIFICATION_INDEX);
+    }
+
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    freecanard_release_rx_payload(ins, transfer);
+    freecanard_give_mutex(&cookie->_rx_mutex);
+    return true;
+}
+
+/**
+ * Complete the asynchronous calls whose timeout elapsed. Blocking calls
+ * handle their own timeout.
+ */
+static void freecanard_expire_calls(CanardInstance *const ins)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (__atomic_load_n(&cookie->_calls_async_pending, __ATOMIC_RELAXED) == 0)
+    {
+        return;
+    }
+
+    const TickType_t now = xTaskGetTickCount();
+    freecanard_call_t *expired = NULL;
+
+    taskENTER_CRITICAL();
+    for (size_t bucket = 0; bucket < FREECANARD_CALL_TABLE_SIZE; bucket++)
+    {
+        freecanard_call_t **link = &cookie->_calls[bucket];
+        while (*link != NULL)
+        {
+            freecanard_call_t *call = *link;
+            if (call->_on_response != NULL && (TickType_t)(now - call->_start_tick) >= call->_timeout)
+            {
+                *link = call->_next;
+                cookie->_calls_async_pending--;
+                call->_next = expired;
+                expired = call;
+                continue;
+            }
+            link = &call->_next;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    // The callback may reuse the call record
+    while (expired != NULL)
+    {
+        freecanard_call_t *next = expired->_next;
+        expired->_on_response(ins, expired, NULL);
+        expired = next;
+    }
+}
+
+/**
+ * Time until the next asynchronous call times out.
+ */
+static TickType_t freecanard_call_timeout(const freecanard_cookie_t *const cookie)
+{
+    TickType_t timeout = portMAX_DELAY;
+
+    if (__atomic_load_n(&cookie->_calls_async_pending, __ATOMIC_RELAXED) == 0)
+    {
+        return timeout;
+    }
+
+    const TickType_t now = xTaskGetTickCount();
+    taskENTER_CRITICAL();
+    for (size_t bucket = 0; bucket < FREECANARD_CALL_TABLE_SIZE; bucket++)
+    {
+        for (const freecanard_call_t *call = cookie->_calls[bucket]; call != NULL; call = call->_next)
+        {
+            if (call->_on_response == NULL)
+            {
+                continue;
+            }
+            const TickType_t elapsed = now - call->_start_tick;
+            const TickType_t remaining = elapsed < call->_timeout ? call->_timeout - elapsed : 0;
+            timeout = remaining < timeout ? remaining : timeout;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return timeout;
+}
+
+/**
+ * Deliver a message published by the node itself to the transfer callback,
+ * or to its mailbox or queue, if the node subscribes to its subject. The
+ * payload is passed as is, cut to the extent of the subscription as libcanard
+ * would.
+ */
+static void freecanard_deliver_local(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    const CanardRxSubscription *sub = freecanard_find_subscription(ins, CanardTransferKindMessage, transfer->port_id);
+
+    CanardTransfer local = *transfer;
+    local.timestamp_usec = FREECANARD_MONOTONIC_USEC();
+    local.remote_node_id = ins->node_id;
+    if (sub != NULL && local.payload_size > sub->_extent)
+    {
+        local.payload_size = sub->_extent;
+    }
+
+    const bool copied =
+        sub != NULL && (freecanard_deliver_sample(cookie, &local) || freecanard_deliver_queued(cookie, &local));
+    freecanard_give_mutex(&cookie->_rx_mutex);
+
+    if (sub == NULL || (!copied && cookie->_on_transfer_received == NULL))
+    {
+        return;
+    }
+
+    FREECANARD_STATS_ADD(cookie, rx_loopback_transfers, 1);
+    if (!copied)
+    {
+        cookie->_on_transfer_received(ins, &local);
+    }
+}
+
+/**
+ * Hand a completed transfer to the application, and release its payload
+ * afterwards.
+ */
+static void freecanard_deliver_transfer(CanardInstance *const ins, CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    // The payload is owned by us until released, so the callback
+    // is executed without holding the reception mutex
+    if (cookie->_on_transfer_received)
+    {
+        cookie->_on_transfer_received(ins, transfer);
+    }
+
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    freecanard_release_rx_payload(ins, transfer);
+    freecanard_give_mutex(&cookie->_rx_mutex);
+}
+
+/**
+ * Time the processing task may block waiting for a new frame before it has to
+ * wake up to run the periodic jobs.
+ */
+static TickType_t freecanard_processing_timeout(const freecanard_cookie_t *const cookie)
+{
+    const TickType_t call_timeout = freecanard_call_timeout(cookie);
+    if (cookie->_rx_session_eviction_multiple == 0 || call_timeout < cookie->_rx_session_eviction_period)
+    {
+        return call_timeout;
+    }
+    return cookie->_rx_session_eviction_period;
+}
+
+/**
+ * Run the RX session eviction sweep if it is enabled and due.
+ */
+static void freecanard_run_rx_session_eviction(CanardInstance *const ins)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    freecanard_take_mutex(&cookie->_rx_mutex);
+
+    const TickType_t now = xTaskGetTickCount();
+    if (cookie->_rx_session_eviction_multiple != 0 &&
+        (now - cookie->_rx_session_eviction_last_tick) >= cookie->_rx_session_eviction_period)
+    {
+        cookie->_rx_session_eviction_last_tick = now;
+
+        // Frame timestamps are provided by the driver, and the sessions are
+        // stamped in the same time base. Extrapolate the current time from the
+        // last received frame to keep evicting while the bus is silent.
+        const TickType_t elapsed_ticks = now - cookie->_rx_last_tick;
+        freecanard_evict_rx_sessions(
+            ins,
+            cookie->_rx_last_timestamp_usec + elapsed_ticks * FREECANARD_USEC_PER_TICK);
+    }
+
+    freecanard_give_mutex(&cookie->_rx_mutex);
+}
+
+/**
+ * Release every RX session which has not started a transfer for longer than
+ * the configured multiple of the transfer-ID timeout of its subscription.
+ *
+ * Note: This function is NOT thread safe.
+ *
+ * @return Number of bytes of the released sessions and payload buffers.
+ */
+static size_t freecanard_evict_rx_sessions(CanardInstance *const ins, const CanardMicrosecond now_usec)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    if (cookie->_rx_session_eviction_multiple == 0)
+    {
+        return 0;
+    }
+
+    // Counted from the sizes libcanard allocated, so that transmission
+    // keeps using the heap during the sweep
+    size_t reclaimed = 0;
+    for (size_t kind = 0; kind < CANARD_NUM_TRANSFER_KINDS; kind++)
+    {
+        for (CanardRxSubscription *sub = ins->_rx_subscriptions[kind]; sub != NULL; sub = sub->_next)
+        {
+            const CanardMicrosecond max_idle_usec =
+                sub->_transfer_id_timeout_usec * cookie->_rx_session_eviction_multiple;
+
+            for (size_t node_id = 0; node_id <= CANARD_NODE_ID_MAX; node_id++)
+            {
+                freecanard_rx_session_t *session = (freecanard_rx_session_t *)sub->_sessions[node_id];
+                if (session == NULL ||
+                    now_usec <= session->transfer_timestamp_usec ||
+                    (now_usec - session->transfer_timestamp_usec) <= max_idle_usec)
+                {
+                    continue;
+                }
+
+                // The payload buffer of a session spans the extent
+                if (session->payload != NULL)
+                {
+                    reclaimed += sub->_extent;
+                }
+                reclaimed += sizeof(freecanard_rx_session_t);
+                ins->memory_free(ins, session->payload);
+                ins->memory_free(ins, session);
+                sub->_sessions[node_id] = NULL;
+                FREECANARD_STATS_ADD(cookie, rx_sessions_evicted, 1);
+            }
+        }
+    }
+
+    FREECANARD_STATS_ADD(cookie, rx_session_bytes_reclaimed, reclaimed);
+    return reclaimed;
+}
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * Reserve a cache line aligned region at the cursor, and advance the cursor
+ * past it.
+ */
+static void *freecanard_arena_carve(uint8_t **const cursor, const size_t size)
+{
+    void *region = (void *)*cursor;
+    *cursor += FREECANARD_ARENA_ALIGN_UP(size);
+    return region;
+}
+#endif
+
+static void freecanard_heap_enter_critical(void)
+{
+    taskENTER_CRITICAL();
+}
+
+static void freecanard_heap_leave_critical(void)
+{
+    taskEXIT_CRITICAL();
+}
+
+static void freecanard_take_mutex(SemaphoreHandle_t *const mutex)
+{
+
+    xSemaphoreTake(*mutex, portMAX_DELAY);
+}
+
+static void freecanard_give_mutex(SemaphoreHandle_t *const mutex)
+{
+    xSemaphoreGive(*mutex);
+}
+
+static void *memory_allocate(CanardInstance *ins, size_t amount)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    // The recycled payload buffers belong to the reception side
+    if (ins == &cookie->_tx_ins)
+    {
+        return o1heapAllocate(cookie->_o1heap, amount);
+    }
+
+    // The payload of a transfer starting on a port with a buffer provider
+    if (cookie->_rx_into_hint != NULL)
+    {
+        void *buffer = freecanard_rx_into_acquire(cookie, amount);
+        if (buffer != NULL)
+        {
+            return buffer;
+        }
+    }
+
+    // Any recycled buffer of the exact size will do, regardless of its origin
+    for (size_t i = 0; i < FREECANARD_RX_PAYLOAD_POOL_CLASSES; i++)
+    {
+        freecanard_payload_pool_t *pool = &cookie->_rx_payload_pools[i];
+        if (pool->references != 0 && pool->extent == amount && pool->head != NULL)
+        {
+            void *buffer = pool->head;
+            pool->head = *(void **)buffer;
+            pool->count--;
+            FREECANARD_STATS_ADD(cookie, rx_payload_pool_hits, 1);
+            return buffer;
+        }
+    }
+
+    void *pointer = o1heapAllocate(cookie->_o1heap, amount);
+    if (pointer == NULL && freecanard_payload_pool_flush(ins))
+    {
+        pointer = o1heapAllocate(cookie->_o1heap, amount);
+    }
+    return pointer;
+}
+
+static void memory_free(CanardInstance *ins, void *pointer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    if (ins != &cookie->_tx_ins && freecanard_rx_into_release(cookie, pointer))
+    {
+        return;
+    }
+    o1heapFree(cookie->_o1heap, pointer);
+}
+
+/**
+ * Apply a subscription change, deferring it to the task processing the bus
+ * when needed, and wait for it to be applied.
+ *
+ * @return Result of the change, see freecanard_apply_rx_update.
+ */
+static int8_t freecanard_update_subscriptions(CanardInstance *const ins, freecanard_rx_update_t *const update)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    // Nobody would apply the change, or it is applied by ourselves anyway
+    if (cookie->_processing_task == NULL ||
+        xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ||
+        xTaskGetCurrentTaskHandle() == cookie->_processing_task)
+    {
+        freecanard_take_mutex(&cookie->_rx_mutex);
+        freecanard_apply_rx_update(ins, update);
+        freecanard_give_mutex(&cookie->_rx_mutex);
+        return update->result;
+    }
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    update->done = xSemaphoreCreateBinaryStatic(&update->done_buffer);
+#else
+    update->done = xSemaphoreCreateBinary();
+    if (update->done == NULL)
+    {
+        return -CANARD_ERROR_OUT_OF_MEMORY;
+    }
+#endif
+
+    // Publish the change without locking, the processing task takes the
+    // whole list at once
+    update->next = __atomic_load_n(&cookie->_rx_updates, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(
+        &cookie->_rx_updates,
+        &update->next,
+        update,
+        true,
+        __ATOMIC_RELEASE,
+        __ATOMIC_RELAXED))
+    {
+    }
+    freecanard_wake_processing(cookie);
+
+    (void)xSemaphoreTake(update->done, portMAX_DELAY);
+    vSemaphoreDelete(update->done);
+    return update->result;
+}
+
+/**
+ * Apply the pending subscription changes, in the order they were requested.
+ * Must only be called by the task processing the bus, in between two frames.
+ */
+static void freecanard_apply_rx_updates(CanardInstance *const ins)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    freecanard_rx_update_t *pending = __atomic_exchange_n(&cookie->_rx_updates, NULL, __ATOMIC_ACQUIRE);
+    if (pending == NULL)
+    {
+        return;
+    }
+
+    freecanard_rx_update_t *ordered = NULL;
+    while (pending != NULL)
+    {
+        freecanard_rx_update_t *next = pending->next;
+        pending->next = ordered;
+        ordered = pending;
+        pending = next;
+    }
+
+    // Workers still release payloads concurrently
+    freecanard_take_mutex(&cookie->_rx_mutex);
+    while (ordered != NULL)
+    {
+        // The update is gone as soon as its requester is released
+        freecanard_rx_update_t *next = ordered->next;
+        freecanard_apply_rx_update(ins, ordered);
+        xSemaphoreGive(ordered->done);
+        ordered = next;
+    }
+    freecanard_give_mutex(&cookie->_rx_mutex);
+}
+
+/**
+ * Subscribe or unsubscribe, keeping the payload buffer pools in sync.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_apply_rx_update(CanardInstance *const ins, freecanard_rx_update_t *const update)
 {
-    CanardInstance *ins = (CanardInstance *)canard_instance;
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
 
-    freecanard_frame_queue_item_t queue_item;
+    if (update->streaming)
+    {
+        update->result = freecanard_apply_stream_update(cookie, update);
+        return;
+    }
+
+    // An existing subscription is replaced, along with its extent
+    const CanardRxSubscription *previous = freecanard_find_subscription(ins, update->transfer_kind, update->port_id);
+    const size_t previous_extent = previous != NULL ? previous->_extent : 0;
+
+    if (update->subscribe)
+    {
+        update->result = canardRxSubscribe(
+            ins,
+            update->transfer_kind,
+            update->port_id,
+            update->extent,
+            update->transfer_id_timeout_usec,
+            update->subscription);
+        if (update->result >= 0)
+        {
+            if (previous != NULL)
+            {
+                freecanard_payload_pool_release(ins, previous_extent);
+            }
+            freecanard_payload_pool_acquire(cookie, update->extent);
+            freecanard_apply_provider_update(cookie, update);
+            freecanard_apply_mailbox_update(cookie, update);
+            freecanard_apply_delivery_queue_update(cookie, update);
+        }
+    }
+    else
+    {
+        update->result = canardRxUnsubscribe(ins, update->transfer_kind, update->port_id);
+        freecanard_apply_provider_update(cookie, update);
+        freecanard_apply_mailbox_update(cookie, update);
+        freecanard_apply_delivery_queue_update(cookie, update);
+        if (update->result == 1)
+        {
+            freecanard_payload_pool_release(ins, previous_extent);
+        }
+    }
+}
+
+/**
+ * Wake the task processing the bus without enqueueing a frame.
+ */
+static void freecanard_wake_processing(freecanard_cookie_t *const cookie)
+{
+    if (cookie->_processing_task_notify)
+    {
+        xTaskNotifyGive(cookie->_processing_task);
+    }
+    else if (cookie->_processing_wakeup != NULL)
+    {
+        xSemaphoreGive(cookie->_processing_wakeup);
+    }
+}
+
+/**
+ * Find the subscription of the given port.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static CanardRxSubscription *freecanard_find_subscription(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id)
+{
+    for (CanardRxSubscription *sub = ins->_rx_subscriptions[transfer_kind]; sub != NULL; sub = sub->_next)
+    {
+        if (sub->_port_id == port_id)
+        {
+            return sub;
+        }
+    }
+    return NULL;
+}
 
-    while (1)
+/**
+ * Register a subscription with the given extent in the payload buffer pools.
+ * Extents too small to hold the free list link, or exceeding the number of
+ * pool classes, are not recycled.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_payload_pool_acquire(freecanard_cookie_t *const cookie, const size_t extent)
+{
+    if (extent < sizeof(void *))
     {
-        // Block until new frame is received
-        bool ret = xQueueReceive(cookie->_processing_task_queue, &queue_item, portMAX_DELAY);
+        return;
+    }
 
-        if (ret != pdTRUE)
+    freecanard_payload_pool_t *unused = NULL;
+    for (size_t i = 0; i < FREECANARD_RX_PAYLOAD_POOL_CLASSES; i++)
+    {
+        freecanard_payload_pool_t *pool = &cookie->_rx_payload_pools[i];
+        if (pool->references != 0 && pool->extent == extent)
         {
-            // This should not happen, if it does drop the frame
-            continue;
+            pool->references++;
+            return;
+        }
+        if (pool->references == 0 && unused == NULL)
+        {
+            unused = pool;
         }
+    }
 
-        CanardFrame canard_frame;
-        freecanard_to_canard_frame(&queue_item.frame_, &canard_frame);
-        canard_frame.timestamp_usec = queue_item.timestamp_usec;
+    if (unused != NULL)
+    {
+        unused->extent = extent;
+        unused->head = NULL;
+        unused->count = 0;
+        unused->references = 1;
+    }
+}
 
-        freecanard_take_mutex(&cookie->_mutex);
-        CanardTransfer transfer;
-        int8_t res = canardRxAccept(
-            ins,
-            &canard_frame,
-            queue_item.redundant_transport_index_,
-            &transfer);
+/**
+ * Unregister a subscription with the given extent from the payload buffer
+ * pools, returning the recycled buffers to the memory pool once the last
+ * subscription with that extent is gone.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_payload_pool_release(CanardInstance *const ins, const size_t extent)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    for (size_t i = 0; i < FREECANARD_RX_PAYLOAD_POOL_CLASSES; i++)
+    {
+        freecanard_payload_pool_t *pool = &cookie->_rx_payload_pools[i];
+        if (pool->references == 0 || pool->extent != extent)
+        {
+            continue;
+        }
 
-        if (res == 1)
+        if (--pool->references == 0)
         {
-            if (cookie->_on_transfer_received)
+            while (pool->head != NULL)
             {
-                cookie->_on_transfer_received(ins, &transfer);
+                void *buffer = pool->head;
+                pool->head = *(void **)buffer;
+                o1heapFree(cookie->_o1heap, buffer);
             }
-            ins->memory_free(ins, (void *)transfer.payload);
+            pool->count = 0;
         }
-        else
+        return;
+    }
+}
+
+/**
+ * Return all recycled payload buffers to the memory pool.
+ *
+ * Note: This function is NOT thread safe.
+ *
+ * @return true if any buffer was returned.
+ */
+static bool freecanard_payload_pool_flush(CanardInstance *const ins)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    bool flushed = false;
+
+    for (size_t i = 0; i < FREECANARD_RX_PAYLOAD_POOL_CLASSES; i++)
+    {
+        freecanard_payload_pool_t *pool = &cookie->_rx_payload_pools[i];
+        while (pool->head != NULL)
         {
-            // An error has occured
-            freecanard_give_mutex(&cookie->_mutex);
-            continue;
+            void *buffer = pool->head;
+            pool->head = *(void **)buffer;
+            o1heapFree(cookie->_o1heap, buffer);
+            flushed = true;
         }
-        freecanard_give_mutex(&cookie->_mutex);
+        pool->count = 0;
     }
+    return flushed;
 }
 
-/* Private helper functions */
+/**
+ * Release the payload of a received transfer, recycling it if possible.
+ *
+ * Libcanard allocates the payload with the size of the subscription extent,
+ * except for anonymous transfers which are allocated with the size of the
+ * frame payload. Only the former may be recycled.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_release_rx_payload(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    void *payload = (void *)transfer->payload;
 
-static void freecanard_take_mutex(SemaphoreHandle_t *const mutex)
+    // Buffers of a provider go back to it, never to the pools
+    if (payload == NULL || freecanard_rx_into_release(cookie, payload))
+    {
+        return;
+    }
+
+    if (transfer->remote_node_id <= CANARD_NODE_ID_MAX)
+    {
+        const CanardRxSubscription *sub = freecanard_find_subscription(
+            ins,
+            transfer->transfer_kind,
+            transfer->port_id);
+
+        for (size_t i = 0; sub != NULL && i < FREECANARD_RX_PAYLOAD_POOL_CLASSES; i++)
+        {
+            freecanard_payload_pool_t *pool = &cookie->_rx_payload_pools[i];
+            if (pool->references != 0 &&
+                pool->extent == sub->_extent &&
+                pool->count < FREECANARD_RX_PAYLOAD_POOL_DEPTH)
+            {
+                *(void **)payload = pool->head;
+                pool->head = payload;
+                pool->count++;
+                return;
+            }
+        }
+    }
+
+    ins->memory_free(ins, payload);
+}
+
+/**
+ * Register the buffer provider of a subscription, or unregister it when the
+ * port is unsubscribed or subscribed without provider. Buffers already on
+ * loan are still handed back to it.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_apply_provider_update(freecanard_cookie_t *const cookie, const freecanard_rx_update_t *const update)
 {
+    freecanard_buffer_provider_t **link = &cookie->_rx_into_providers;
+    while (*link != NULL &&
+           ((*link)->_transfer_kind != update->transfer_kind || (*link)->_port_id != update->port_id))
+    {
+        link = &(*link)->_next;
+    }
+    if (*link != NULL)
+    {
+        *link = (*link)->_next;
+    }
 
-    xSemaphoreTake(*mutex, portMAX_DELAY);
+    freecanard_buffer_provider_t *const provider = update->provider;
+    if (update->subscribe && provider != NULL)
+    {
+        provider->_transfer_kind = update->transfer_kind;
+        provider->_port_id = update->port_id;
+        provider->_next = cookie->_rx_into_providers;
+        cookie->_rx_into_providers = provider;
+    }
 }
 
-static void freecanard_give_mutex(SemaphoreHandle_t *const mutex)
+/**
+ * Register the mailbox of a sampled subscription, or unregister it when the
+ * port is unsubscribed or subscribed without mailbox.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_apply_mailbox_update(freecanard_cookie_t *const cookie, const freecanard_rx_update_t *const update)
 {
-    xSemaphoreGive(*mutex);
+    freecanard_mailbox_t **link = &cookie->_mailboxes;
+    while (*link != NULL &&
+           ((*link)->_transfer_kind != update->transfer_kind || (*link)->_port_id != update->port_id))
+    {
+        link = &(*link)->_next;
+    }
+    if (*link != NULL)
+    {
+        *link = (*link)->_next;
+    }
+
+    freecanard_mailbox_t *const mailbox = update->mailbox;
+    if (update->subscribe && mailbox != NULL)
+    {
+        // The samples are left alone, the reader may still hold one of them,
+        // and none is returned again until a new one is written
+        mailbox->_transfer_kind = update->transfer_kind;
+        mailbox->_port_id = update->port_id;
+        mailbox->_buffer = update->mailbox_buffer;
+        mailbox->_extent = update->extent;
+        mailbox->_back = 0;
+        mailbox->_middle = 1;
+        mailbox->_front = 2;
+        mailbox->_received = false;
+        mailbox->_written = 0;
+        mailbox->_next = cookie->_mailboxes;
+        cookie->_mailboxes = mailbox;
+    }
 }
 
-static void *memory_allocate(CanardInstance *ins, size_t amount)
+/**
+ * Copy a transfer into the mailbox of its port, if any, and make it the
+ * latest sample.
+ *
+ * @return true if the port has a mailbox, and the transfer must not be
+ * passed to the transfer callback.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static bool freecanard_deliver_sample(freecanard_cookie_t *const cookie, const CanardTransfer *const transfer)
 {
-    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    return o1heapAllocate(cookie->_o1heap, amount);
+    freecanard_mailbox_t *mailbox = cookie->_mailboxes;
+    while (mailbox != NULL &&
+           (mailbox->_transfer_kind != transfer->transfer_kind || mailbox->_port_id != transfer->port_id))
+    {
+        mailbox = mailbox->_next;
+    }
+    if (mailbox == NULL)
+    {
+        return false;
+    }
+
+    // The back slot belongs to the writer until swapped into the middle
+    uint8_t *payload = mailbox->_buffer + (size_t)mailbox->_back * mailbox->_extent;
+    CanardTransfer *sample = &mailbox->_samples[mailbox->_back];
+    *sample = *transfer;
+    sample->payload_size = transfer->payload_size < mailbox->_extent ? transfer->payload_size : mailbox->_extent;
+    sample->payload = payload;
+    if (sample->payload_size > 0)
+    {
+        memcpy(payload, transfer->payload, sample->payload_size);
+    }
+
+    mailbox->_back = __atomic_exchange_n(
+                         &mailbox->_middle,
+                         (uint8_t)(mailbox->_back | FREECANARD_MAILBOX_FRESH),
+                         __ATOMIC_ACQ_REL) &
+                     FREECANARD_MAILBOX_INDEX;
+    __atomic_fetch_add(&mailbox->_written, 1U, __ATOMIC_RELAXED);
+    return true;
 }
 
-static void memory_free(CanardInstance *ins, void *pointer)
+/**
+ * Attach the delivery queue of a queued subscription, or detach it when the
+ * port is unsubscribed or subscribed without queue.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_apply_delivery_queue_update(
+    freecanard_cookie_t *const cookie,
+    const freecanard_rx_update_t *const update)
+{
+    freecanard_delivery_queue_t **link = &cookie->_delivery_queues;
+    while (*link != NULL &&
+           ((*link)->_transfer_kind != update->transfer_kind || (*link)->_port_id != update->port_id))
+    {
+        link = &(*link)->_next;
+    }
+    if (*link != NULL)
+    {
+        *link = (*link)->_next;
+    }
+
+    freecanard_delivery_queue_t *const queue = update->delivery_queue;
+    if (update->subscribe && queue != NULL)
+    {
+        queue->_transfer_kind = update->transfer_kind;
+        queue->_port_id = update->port_id;
+        queue->_next = cookie->_delivery_queues;
+        cookie->_delivery_queues = queue;
+    }
+}
+
+/**
+ * Copy a transfer into the delivery queue of its port, if any, without
+ * waiting. A full queue drops a transfer according to its policy.
+ *
+ * @return true if the port has a delivery queue, and the transfer must not
+ * be passed to the transfer callback.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static bool freecanard_deliver_queued(freecanard_cookie_t *const cookie, const CanardTransfer *const transfer)
+{
+    freecanard_delivery_queue_t *queue = cookie->_delivery_queues;
+    while (queue != NULL && (queue->_transfer_kind != transfer->transfer_kind || queue->_port_id != transfer->port_id))
+    {
+        queue = queue->_next;
+    }
+    if (queue == NULL)
+    {
+        return false;
+    }
+
+    freecanard_stage_queued(queue, transfer);
+    if (xQueueSendToBack(queue->_queue, queue->_staging, 0) == pdTRUE)
+    {
+        return true;
+    }
+
+    if (queue->_policy == FREECANARD_DROP_OLDEST)
+    {
+        // The oldest transfer is received into the staging buffer, so the
+        // new one is staged again
+        if (xQueueReceive(queue->_queue, queue->_staging, 0) == pdTRUE)
+        {
+            __atomic_fetch_add(&queue->_drops, 1U, __ATOMIC_RELAXED);
+        }
+        freecanard_stage_queued(queue, transfer);
+        if (xQueueSendToBack(queue->_queue, queue->_staging, 0) == pdTRUE)
+        {
+            return true;
+        }
+    }
+
+    // The new transfer is dropped
+    __atomic_fetch_add(&queue->_drops, 1U, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * Lay out a transfer and its payload, cut to the extent, as an item of a
+ * delivery queue in its staging buffer.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_stage_queued(freecanard_delivery_queue_t *const queue, const CanardTransfer *const transfer)
+{
+    CanardTransfer header = *transfer;
+    header.payload_size = transfer->payload_size < queue->_extent ? transfer->payload_size : queue->_extent;
+    header.payload = NULL;
+    memcpy(queue->_staging, &header, sizeof(header));
+    if (header.payload_size > 0)
+    {
+        memcpy(queue->_staging + sizeof(header), transfer->payload, header.payload_size);
+    }
+}
+
+/**
+ * Tell memory_allocate which provider shall supply the payload buffer, if the
+ * frame starts a transfer on a port with a buffer provider.
+ *
+ * Libcanard allocates the session of a source node, if it has none yet,
+ * right before the payload buffer. That allocation is left to the pool.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_set_rx_into_hint(
+    CanardInstance *const ins,
+    const freecanard_frame_t *const frame,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
-    o1heapFree(cookie->_o1heap, pointer);
+
+    if (frame->data_len == 0 || (frame->data[frame->data_len - 1U] & 0x80U) == 0U)
+    {
+        return;
+    }
+
+    freecanard_buffer_provider_t *provider = cookie->_rx_into_providers;
+    while (provider != NULL && (provider->_transfer_kind != transfer_kind || provider->_port_id != port_id))
+    {
+        provider = provider->_next;
+    }
+    const CanardRxSubscription *sub = freecanard_find_subscription(ins, transfer_kind, port_id);
+    if (provider == NULL || sub == NULL)
+    {
+        return;
+    }
+
+    const bool anonymous = transfer_kind == CanardTransferKindMessage && (frame->id & (1UL << 24U)) != 0U;
+    cookie->_rx_into_hint = provider;
+    cookie->_rx_into_hint_skip_session = !anonymous && sub->_sessions[frame->id & CANARD_NODE_ID_MAX] == NULL;
+}
+
+/**
+ * Obtain the payload buffer of a starting transfer from the provider hinted
+ * at, and keep track of it until it is freed.
+ *
+ * @return The buffer, or NULL if it shall come from the pool.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void *freecanard_rx_into_acquire(freecanard_cookie_t *const cookie, const size_t amount)
+{
+    if (cookie->_rx_into_hint_skip_session)
+    {
+        cookie->_rx_into_hint_skip_session = false;
+        return NULL;
+    }
+
+    freecanard_buffer_provider_t *const provider = cookie->_rx_into_hint;
+    cookie->_rx_into_hint = NULL;
+    if (cookie->_rx_into_outstanding == FREECANARD_RX_INTO_MAX_BUFFERS)
+    {
+        return NULL;
+    }
+
+    void *buffer = provider->acquire(provider, amount);
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < FREECANARD_RX_INTO_MAX_BUFFERS; i++)
+    {
+        if (cookie->_rx_into_buffers[i].buffer == NULL)
+        {
+            cookie->_rx_into_buffers[i].buffer = buffer;
+            cookie->_rx_into_buffers[i].provider = provider;
+            cookie->_rx_into_outstanding++;
+            break;
+        }
+    }
+    return buffer;
+}
+
+/**
+ * Hand a buffer back to the provider it was obtained from.
+ *
+ * @return true if the buffer came from a provider, false if it belongs to
+ * the memory pool.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static bool freecanard_rx_into_release(freecanard_cookie_t *const cookie, void *const buffer)
+{
+    // libcanard frees NULL after every transfer, which must not match an
+    // empty slot
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; cookie->_rx_into_outstanding > 0 && i < FREECANARD_RX_INTO_MAX_BUFFERS; i++)
+    {
+        freecanard_rx_into_buffer_t *entry = &cookie->_rx_into_buffers[i];
+        if (entry->buffer == buffer)
+        {
+            entry->buffer = NULL;
+            cookie->_rx_into_outstanding--;
+            entry->provider->release(entry->provider, buffer);
+            return true;
+        }
+    }
+    return false;
 }
 
 static void freecanard_to_canard_frame(const freecanard_frame_t *const freecanardFrame, CanardFrame *const canardFrame)
@@ -287,6 +3484,37 @@ static void canard_to_freecanard_frame(const CanardFrame *const canardFrame, fre
     memcpy(freecanardFrame->data, canardFrame->payload, canardFrame->payload_size);
 }
 
+/**
+ * Decide whether the transfer may be enqueued given the current memory
+ * pressure, see freecanard_set_tx_admission.
+ *
+ * Note: This function is NOT thread safe.
+ *
+ * @return 0 if admitted, otherwise a negated FREECANARD_ERROR_TX_* code.
+ */
+static int32_t freecanard_admit_transfer(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    if (cookie->_tx_soft_watermark == SIZE_MAX && cookie->_tx_hard_watermark == SIZE_MAX)
+    {
+        return 0;
+    }
+
+    const size_t allocated = o1heapGetDiagnostics(cookie->_o1heap).allocated;
+    if (allocated >= cookie->_tx_hard_watermark && transfer->priority != CanardPriorityExceptional)
+    {
+        FREECANARD_STATS_ADD(cookie, tx_transfers_shed, 1);
+        return -FREECANARD_ERROR_TX_HARD_WATERMARK;
+    }
+    if (allocated >= cookie->_tx_soft_watermark && transfer->priority > cookie->_tx_soft_watermark_priority)
+    {
+        FREECANARD_STATS_ADD(cookie, tx_transfers_shed, 1);
+        return -FREECANARD_ERROR_TX_SOFT_WATERMARK;
+    }
+    return 0;
+}
+
 /**
  * Transmit transfer by first pushing the transfer to the TX queue, before 
  * dequeueing all frames, and transmit them one by one.
@@ -294,12 +3522,35 @@ static void canard_to_freecanard_frame(const CanardFrame *const canardFrame, fre
  * Note: This function is NOT thread safe.
  *
  * @param ins   Canard instance to transmit all frames from.
+ *
+ * @return Result of canardTxPush.
+ */
+static int32_t freecanard_transmit_transfer(CanardInstance *const ins, const CanardTransfer *const transfer)
+{
+    freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+
+    const int32_t push_res = canardTxPush(ins, transfer);
+    if (push_res == -CANARD_ERROR_OUT_OF_MEMORY)
+    {
+        FREECANARD_STATS_ADD(cookie, tx_out_of_memory, 1);
+    }
+    freecanard_flush_tx_queue(ins);
+    return push_res;
+}
+
+/**
+ * Hand the frames of the TX queue to the driver, until the queue is empty or
+ * the driver is busy.
+ *
+ * Note: This function is NOT thread safe.
+ *
+ * @return true if any frame was handed to the driver.
  */
-static void freecanard_transmit_transfer(CanardInstance *const ins, const CanardTransfer *const transfer)
+static bool freecanard_flush_tx_queue(CanardInstance *const ins)
 {
     freecanard_cookie_t *cookie = (freecanard_cookie_t *)ins->user_reference;
+    bool sent = false;
 
-    canardTxPush(ins, transfer);
     for (const CanardFrame *txf = NULL; (txf = canardTxPeek(ins)) != NULL;) // Look at the top of the TX queue.
     {
         bool can_fd = ins->mtu_bytes == CANARD_MTU_CAN_FD ? true : false;
@@ -310,5 +3561,7 @@ static void freecanard_transmit_transfer(CanardInstance *const ins, const Canard
         }
         canardTxPop(ins);                          // Remove the frame from the queue after it's transmitted.
         ins->memory_free(ins, (CanardFrame *)txf); // Deallocate the dynamic memory afterwards.
+        sent = true;
     }
+    return sent;
 }
\ No newline at end of file
@@ -4,13 +4,308 @@
 #include <FreeRTOS.h>
 #include <semphr.h>
 #include <queue.h>
+#include <task.h>
+#include <timers.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "canard.h"
 #include "o1heap.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 #define FREECANARD_DEFAULT_PROCESSING_TASK_QUEUE_SIZE 10
+#define FREECANARD_DEFAULT_PROCESSING_TASK_STACK_SIZE configMINIMAL_STACK_SIZE
+
+/**
+ * Processing task stack size requesting no dedicated processing task, e.g.
+ * for buses serviced by a shared reactor, see @ref freecanard_reactor_attach.
+ */
+#define FREECANARD_NO_PROCESSING_TASK 0U
+
+/**
+ * Monotonic time in microseconds used to enforce the time budget of
+ * @ref freecanard_poll. Defaults to the tick count, and may be overridden
+ * with a finer time base, e.g. a free running hardware timer.
+ */
+#ifndef FREECANARD_MONOTONIC_USEC
+#define FREECANARD_MONOTONIC_USEC() ((uint64_t)xTaskGetTickCount() * (1000000ULL / configTICK_RATE_HZ))
+#endif
+
+/**
+ * Number of cores the FreeRTOS kernel schedules tasks on. Always 1, unless
+ * built against the FreeRTOS SMP kernel.
+ */
+#if defined(configNUMBER_OF_CORES)
+#define FREECANARD_NUM_CORES configNUMBER_OF_CORES
+#elif defined(configNUM_CORES)
+#define FREECANARD_NUM_CORES configNUM_CORES
+#else
+#define FREECANARD_NUM_CORES 1
+#endif
+
+/**
+ * Maximum number of buses serviced by a single reactor.
+ */
+#ifndef FREECANARD_REACTOR_MAX_BUSES
+#define FREECANARD_REACTOR_MAX_BUSES 6
+#endif
+
+/**
+ * Default multiple of a subscription's transfer-ID timeout after which an
+ * idle RX session is considered stale, see @ref freecanard_set_rx_session_eviction.
+ */
+#define FREECANARD_DEFAULT_RX_SESSION_EVICTION_MULTIPLE 4
+
+/**
+ * Number of distinct subscription extents for which received payload buffers
+ * are recycled instead of being returned to the memory pool.
+ */
+#ifndef FREECANARD_RX_PAYLOAD_POOL_CLASSES
+#define FREECANARD_RX_PAYLOAD_POOL_CLASSES 4
+#endif
+
+/**
+ * Maximum number of recycled payload buffers kept per extent.
+ */
+#ifndef FREECANARD_RX_PAYLOAD_POOL_DEPTH
+#define FREECANARD_RX_PAYLOAD_POOL_DEPTH 2
+#endif
+
+/**
+ * Maximum number of payload buffers obtained from buffer providers held at
+ * once by a bus, see @ref freecanard_subscribe_into. Payloads are reassembled
+ * into the memory pool while all are in use.
+ */
+#ifndef FREECANARD_RX_INTO_MAX_BUFFERS
+#define FREECANARD_RX_INTO_MAX_BUFFERS 4
+#endif
+
+/**
+ * Maximum number of handler worker tasks per bus.
+ */
+#ifndef FREECANARD_MAX_WORKERS
+#define FREECANARD_MAX_WORKERS 4
+#endif
+
+/**
+ * Error codes returned by @ref freecanard_transmit in addition to the ones of
+ * canardTxPush. Chosen to not collide with the CANARD_ERROR_* codes.
+ */
+#define FREECANARD_ERROR_TX_SOFT_WATERMARK 16
+#define FREECANARD_ERROR_TX_HARD_WATERMARK 17
+
+/**
+ * Error codes returned by @ref freecanard_call and @ref freecanard_call_async.
+ */
+#define FREECANARD_ERROR_CALL_TIMEOUT 18
+#define FREECANARD_ERROR_CALL_BUSY 19
+
+/**
+ * Number of buckets of the table of outstanding service calls, see
+ * @ref freecanard_call. Must be a power of two.
+ */
+#ifndef FREECANARD_CALL_TABLE_SIZE
+#define FREECANARD_CALL_TABLE_SIZE 16U
+#endif
+
+/**
+ * Index of the task notification a task blocked in @ref freecanard_call waits
+ * on. The application must not use this index in tasks performing calls.
+ * Index 0 is the one of xTaskNotifyGive and ulTaskNotifyTake, so
+ * configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 2.
+ */
+#ifndef FREECANARD_CALL_NOTIFICATION_INDEX
+#define FREECANARD_CALL_NOTIFICATION_INDEX (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1)
+#endif
+
+#if (configTASK_NOTIFICATION_ARRAY_ENTRIES < 2) || (FREECANARD_CALL_NOTIFICATION_INDEX == 0)
+#error "freecanard_call needs a task notification index of its own, set configTASK_NOTIFICATION_ARRAY_ENTRIES to at least 2"
+#endif
+
+/**
+ * @brief Runtime statistics of a Freecanard instance.
+ *
+ * Retrieved with @ref freecanard_get_stats.
+ */
+typedef struct
+{
+    /**
+     * Number of stale RX sessions released by the eviction sweep.
+     */
+    uint32_t rx_sessions_evicted;
+
+    /**
+     * Total number of bytes of the sessions and payload buffers released by
+     * the eviction sweep.
+     */
+    size_t rx_session_bytes_reclaimed;
+
+    /**
+     * Number of transfers rejected by the TX admission control.
+     */
+    uint32_t tx_transfers_shed;
+
+    /**
+     * Number of transfers that could not be enqueued as the memory pool was
+     * exhausted.
+     */
+    uint32_t tx_out_of_memory;
+
+    /**
+     * Number of received payload buffers served from the recycled buffers
+     * instead of the memory pool.
+     */
+    uint32_t rx_payload_pool_hits;
+
+    /**
+     * Number of received transfers dropped because the queue of the handler
+     * worker task was full.
+     */
+    uint32_t rx_worker_queue_overflows;
+
+    /**
+     * Number of times the processing task priority was boosted, see
+     * @ref freecanard_set_priority_boost.
+     */
+    uint32_t processing_priority_boosts;
+
+    /**
+     * Total and longest time in ticks the processing task spent boosted.
+     * A boost still in progress is not accounted for.
+     */
+    uint32_t processing_priority_boost_ticks;
+    uint32_t processing_priority_boost_max_ticks;
+
+    /**
+     * Number of received frames dropped by the port filter, see
+     * @ref freecanard_set_rx_port_filter.
+     */
+    uint32_t rx_frames_filtered;
+
+    /**
+     * Number of published messages delivered locally, see
+     * @ref freecanard_set_loopback.
+     */
+    uint32_t rx_loopback_transfers;
+
+    /**
+     * Number of transfers aborted on streaming subscriptions, see
+     * @ref freecanard_subscribe_stream.
+     */
+    uint32_t rx_stream_aborts;
+} freecanard_stats_t;
+
+/**
+ * Number of 32-bit words of a port filter bitmap covering all subject-IDs,
+ * respectively all service-IDs, see @ref freecanard_port_filter_t.
+ */
+#define FREECANARD_SUBJECT_FILTER_WORDS ((CANARD_SUBJECT_ID_MAX + 1U) / 32U)
+#define FREECANARD_SERVICE_FILTER_WORDS ((CANARD_SERVICE_ID_MAX + 1U) / 32U)
+
+/**
+ * @brief Set of ports accepted by the reception path, see
+ * @ref freecanard_set_rx_port_filter.
+ *
+ * Bit (port_id % 32) of word (port_id / 32) is set for every accepted port.
+ */
+typedef struct
+{
+    /**
+     * Bitmaps indexed by @ref CanardTransferKind, of
+     * FREECANARD_SUBJECT_FILTER_WORDS words for messages and of
+     * FREECANARD_SERVICE_FILTER_WORDS words for responses and requests.
+     * NULL rejects every port of the kind.
+     */
+    const uint32_t *ports[CANARD_NUM_TRANSFER_KINDS];
+} freecanard_port_filter_t;
+
+/**
+ * @brief Free list of recycled received payload buffers of a given extent.
+ *
+ * @note For internal use only.
+ */
+typedef struct
+{
+    size_t extent;
+    void *head;
+    uint8_t count;
+    uint8_t references;
+} freecanard_payload_pool_t;
+
+/**
+ * @brief CAN(-FD) data frame.
+ *
+ * @note For internal use only, exposed for the sizing macros below.
+ */
+typedef struct
+{
+    uint32_t id;
+    uint8_t data[CANARD_MTU_CAN_FD];
+    size_t data_len;
+} freecanard_frame_t;
+
+/**
+ * @brief Item of the processing task queue.
+ *
+ * @note For internal use only, exposed for the sizing macros below.
+ */
+typedef struct
+{
+    const freecanard_frame_t frame_;
+    CanardMicrosecond timestamp_usec;
+    const uint8_t redundant_transport_index_;
+} freecanard_frame_queue_item_t;
+
+/**
+ * Size in bytes of the storage area needed by a processing task queue
+ * holding @p queue_size frames, see @ref freecanard_static_buffers_t.
+ */
+#define FREECANARD_PROCESSING_TASK_QUEUE_STORAGE_SIZE(queue_size) \
+    ((size_t)(queue_size) * sizeof(freecanard_frame_queue_item_t))
+
+/**
+ * Size in bytes of a cache line on the target. Regions carved out of an arena
+ * by @ref freecanard_init_arena never share a cache line.
+ */
+#ifndef FREECANARD_CACHE_LINE_SIZE
+#define FREECANARD_CACHE_LINE_SIZE 32U
+#endif
+
+/**
+ * Required alignment of an arena passed to @ref freecanard_init_arena.
+ */
+#define FREECANARD_ARENA_ALIGNMENT \
+    (FREECANARD_CACHE_LINE_SIZE > O1HEAP_ALIGNMENT ? FREECANARD_CACHE_LINE_SIZE : O1HEAP_ALIGNMENT)
+
+#define FREECANARD_ARENA_ALIGN_UP(size) \
+    ((((size_t)(size)) + FREECANARD_ARENA_ALIGNMENT - 1U) / FREECANARD_ARENA_ALIGNMENT * FREECANARD_ARENA_ALIGNMENT)
+
+/**
+ * Smallest memory pool o1heap accepts, with room for a single block. An upper
+ * bound of the size of the heap instance, which holds a bin per bit of
+ * size_t, plus the alignment slack and the smallest fragment.
+ */
+#define FREECANARD_MIN_MEMORY_POOL_SIZE \
+    (sizeof(void *) * sizeof(size_t) * 8U + 16U * sizeof(uint64_t) + 4U * O1HEAP_ALIGNMENT)
+
+/**
+ * Size in bytes of an arena holding all resources of a bus, see
+ * @ref freecanard_init_arena.
+ */
+#define FREECANARD_ARENA_SIZE(processing_task_queue_size, processing_task_stack_size, memory_pool_size) \
+    ((FREECANARD_ARENA_ALIGN_UP(sizeof(StaticQueue_t)) +                                              \
+      FREECANARD_ARENA_ALIGN_UP(FREECANARD_PROCESSING_TASK_QUEUE_STORAGE_SIZE(processing_task_queue_size))) * \
+         FREECANARD_NUM_CORES +                                                                         \
+     FREECANARD_ARENA_ALIGN_UP(sizeof(freecanard_cookie_t)) +                                         \
+     FREECANARD_ARENA_ALIGN_UP(sizeof(StaticSemaphore_t)) * 2U +                                      \
+     FREECANARD_ARENA_ALIGN_UP(sizeof(StaticTask_t)) +                                                \
+     FREECANARD_ARENA_ALIGN_UP((size_t)(processing_task_stack_size) * sizeof(StackType_t)) +          \
+     FREECANARD_ARENA_ALIGN_UP(memory_pool_size))
 
 /**
  * @brief Platform agnostic function that are used to send a frame over your 
@@ -37,6 +332,12 @@ typedef int8_t (*freecanard_platform_send)(
  * 
  * @note This callback function is called from normal context, i.e. a task, 
  * NOT from within an Interrupt Service Routine (ISR).
+ *
+ * @note No Freecanard lock is held while the callback executes, so it may
+ * call any function of the Freecanard API, e.g. to respond to a request.
+ *
+ * @note The callback is executed by the processing task, or by a worker task
+ * if a worker pool is used, see @ref freecanard_workers_init.
  * 
  * @param ins The instance for which the transfer have been processed.
  * @param transfer The received transfer. @note The transfer is invalidated 
@@ -46,6 +347,378 @@ typedef void (*freecanard_on_transfer_received)(
     CanardInstance *ins,
     const CanardTransfer *const transfer);
 
+struct freecanard_rx_update;
+
+/**
+ * @brief Response to a service call, see @ref freecanard_call.
+ */
+typedef struct
+{
+    /**
+     * Buffer receiving the response payload, provided by the application.
+     */
+    void *payload;
+
+    /**
+     * Size of the payload buffer in bytes. Longer responses are truncated.
+     */
+    size_t payload_capacity;
+
+    /**
+     * Size of the received payload in bytes, after truncation.
+     */
+    size_t payload_size;
+
+    /**
+     * Reception timestamp of the response.
+     */
+    CanardMicrosecond timestamp_usec;
+} freecanard_response_t;
+
+typedef struct freecanard_call freecanard_call_t;
+
+/**
+ * @brief Callback function executed when an asynchronous service call
+ * completes, see @ref freecanard_call_async.
+ *
+ * @note Executed by the processing task, without any Freecanard lock held.
+ *
+ * @param ins The instance on which the call was made.
+ *
+ * @param call The completed call, which may be reused from within the
+ * callback.
+ *
+ * @param response The response, or NULL if the call timed out. @note The
+ * response is invalidated after the point of return of this function.
+ */
+typedef void (*freecanard_on_response)(
+    CanardInstance *ins,
+    freecanard_call_t *call,
+    const CanardTransfer *const response);
+
+/**
+ * @brief Outstanding service call.
+ *
+ * Provided by the application for every call, and must remain valid until
+ * the call completes.
+ */
+struct freecanard_call
+{
+    /**
+     * User pointer available for the application, e.g. to find its context
+     * from the response callback.
+     */
+    void *user_reference_;
+
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    struct freecanard_call *_next;
+    CanardPortID _service_id;
+    CanardNodeID _server_node_id;
+    CanardTransferID _transfer_id;
+    TickType_t _start_tick;
+    TickType_t _timeout;
+    bool _completed;
+    freecanard_on_response _on_response;
+    TaskHandle_t _task;
+    freecanard_response_t *_response;
+};
+
+/**
+ * Size in bytes of the buffer of a mailbox for a subscription of the given
+ * extent, see @ref freecanard_subscribe_sampled.
+ */
+#define FREECANARD_MAILBOX_BUFFER_SIZE(extent) (3U * (extent))
+
+/**
+ * @brief Mailbox holding the latest transfer of a sampled subscription, see
+ * @ref freecanard_subscribe_sampled.
+ *
+ * A triple buffer: the bus writes a new sample into a back slot, then swaps
+ * it with the middle slot. The reader swaps the middle slot with its front
+ * slot when a new sample is there. Neither ever waits for the other. The
+ * storage is provided by the application, and shall remain valid until the
+ * subscription is removed.
+ */
+typedef struct freecanard_mailbox
+{
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    struct freecanard_mailbox *_next;
+    CanardTransferKind _transfer_kind;
+    CanardPortID _port_id;
+    CanardTransfer _samples[3];
+    uint8_t *_buffer;
+    size_t _extent;
+    uint8_t _back;
+    uint8_t _middle;
+    uint8_t _front;
+    bool _received;
+    uint32_t _written;
+} freecanard_mailbox_t;
+
+/**
+ * Size in bytes of an item of a delivery queue, and of the buffer it is
+ * received into, for a subscription of the given extent, see
+ * @ref freecanard_delivery_queue_receive.
+ */
+#define FREECANARD_DELIVERY_ITEM_SIZE(extent) (sizeof(CanardTransfer) + (extent))
+
+/**
+ * Size in bytes of the storage area needed by a delivery queue holding
+ * @p depth transfers, see @ref freecanard_delivery_queue_init_static.
+ */
+#define FREECANARD_DELIVERY_QUEUE_STORAGE_SIZE(extent, depth) \
+    (((size_t)(depth) + 1U) * FREECANARD_DELIVERY_ITEM_SIZE(extent))
+
+/**
+ * @brief What a full delivery queue does with a new transfer.
+ */
+typedef enum
+{
+    /**
+     * The new transfer is dropped.
+     */
+    FREECANARD_DROP_NEWEST,
+
+    /**
+     * The oldest transfer waiting in the queue is dropped to make room for
+     * the new one.
+     */
+    FREECANARD_DROP_OLDEST,
+} freecanard_overflow_policy_t;
+
+/**
+ * @brief Bounded queue of the transfers of a queued subscription, see
+ * @ref freecanard_subscribe_queued.
+ *
+ * The storage is provided by the application, and shall remain valid until
+ * the subscription is removed.
+ */
+typedef struct freecanard_delivery_queue
+{
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    struct freecanard_delivery_queue *_next;
+    CanardTransferKind _transfer_kind;
+    CanardPortID _port_id;
+    QueueHandle_t _queue;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    StaticQueue_t _queue_buffer;
+#endif
+    uint8_t *_staging;
+    size_t _extent;
+    freecanard_overflow_policy_t _policy;
+    uint32_t _drops;
+} freecanard_delivery_queue_t;
+
+typedef struct freecanard_buffer_provider freecanard_buffer_provider_t;
+
+/**
+ * @brief Provider of the buffers into which the transfers of a subscription
+ * are reassembled, see @ref freecanard_subscribe_into.
+ *
+ * The storage is provided by the application, and shall remain valid until
+ * the subscription is removed.
+ *
+ * @note The callbacks are executed with the reception lock held, by the task
+ * processing the bus or releasing the transfer. They shall not call any
+ * function of the Freecanard API.
+ */
+struct freecanard_buffer_provider
+{
+    /**
+     * User defined reference, e.g. to a ring of samples.
+     * Not used by Freecanard.
+     */
+    void *user_reference_;
+
+    /**
+     * Provide a buffer of at least @p size bytes, the extent of the
+     * subscription, at the start of a transfer. Returning NULL reassembles
+     * the transfer into the memory pool instead.
+     */
+    void *(*acquire)(freecanard_buffer_provider_t *provider, const size_t size);
+
+    /**
+     * Take back a buffer, once the transfer callback has returned, or if the
+     * transfer was dropped. The provider may keep the data, e.g. by
+     * advancing a ring.
+     */
+    void (*release)(freecanard_buffer_provider_t *provider, void *buffer);
+
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    freecanard_buffer_provider_t *_next;
+    CanardTransferKind _transfer_kind;
+    CanardPortID _port_id;
+};
+
+/**
+ * @brief Payload buffer on loan from a buffer provider.
+ *
+ * @note For internal use only.
+ */
+typedef struct
+{
+    void *buffer;
+    freecanard_buffer_provider_t *provider;
+} freecanard_rx_into_buffer_t;
+
+/**
+ * @brief Event of a streaming subscription, see @ref freecanard_on_stream.
+ */
+typedef enum
+{
+    /**
+     * The next chunk of the payload of a transfer.
+     */
+    FREECANARD_STREAM_CHUNK,
+
+    /**
+     * The transfer is complete and its CRC is valid.
+     */
+    FREECANARD_STREAM_END,
+
+    /**
+     * The transfer is discarded, as its CRC is invalid, or as it was
+     * interrupted by a new transfer after the transfer-ID timeout. The chunks
+     * delivered so far shall be dropped.
+     */
+    FREECANARD_STREAM_ABORT,
+} freecanard_stream_event_t;
+
+typedef struct freecanard_stream freecanard_stream_t;
+
+/**
+ * @brief Callback function receiving the events of a streaming subscription,
+ * see @ref freecanard_subscribe_stream.
+ *
+ * @note Executed by the task processing the bus, even when a worker pool is
+ * used, without any Freecanard lock held.
+ *
+ * @param ins The instance receiving the transfer.
+ *
+ * @param stream The streaming subscription.
+ *
+ * @param event The event.
+ *
+ * @param chunk Metadata of the transfer, as for a reassembled transfer. With
+ * FREECANARD_STREAM_CHUNK, its payload is the chunk, otherwise it is empty.
+ * @note The chunk is invalidated after the point of return of this function.
+ *
+ * @param offset Offset of the chunk within the payload of the transfer, or
+ * total size of the payload with FREECANARD_STREAM_END.
+ */
+typedef void (*freecanard_on_stream)(
+    CanardInstance *ins,
+    freecanard_stream_t *stream,
+    const freecanard_stream_event_t event,
+    const CanardTransfer *const chunk,
+    const size_t offset);
+
+/**
+ * @brief Streaming subscription, see @ref freecanard_subscribe_stream.
+ *
+ * The storage is provided by the application, and shall remain valid until
+ * the subscription is removed.
+ */
+struct freecanard_stream
+{
+    /**
+     * User defined reference, e.g. to the file being received.
+     * Not used by Freecanard.
+     */
+    void *user_reference_;
+
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    freecanard_stream_t *_next;
+    CanardTransferKind _transfer_kind;
+    CanardPortID _port_id;
+    CanardMicrosecond _transfer_id_timeout_usec;
+    freecanard_on_stream _on_stream;
+
+    bool _active;
+    bool _toggle;
+    CanardPriority _priority;
+    CanardNodeID _source_node_id;
+    CanardTransferID _transfer_id;
+    uint8_t _redundant_transport_index;
+    CanardMicrosecond _timestamp_usec;
+    uint16_t _crc;
+    size_t _offset;
+    uint8_t _chunk[CANARD_MTU_CAN_FD + 2U];
+    size_t _holdback_size;
+
+    CanardNodeID _last_source_node_id;
+    CanardTransferID _last_transfer_id;
+    CanardMicrosecond _last_timestamp_usec;
+};
+
+/**
+ * @brief Callback function serializing the source object of a payload cache,
+ * see @ref freecanard_payload_cache_init.
+ *
+ * @param source The source object.
+ *
+ * @param buffer Buffer receiving the serialized object.
+ *
+ * @param inout_size Size of the buffer on entry, size of the serialized
+ * object on return.
+ *
+ * @return 0 on success, <0 on error.
+ */
+typedef int8_t (*freecanard_cache_serialize)(
+    const void *const source,
+    uint8_t *const buffer,
+    size_t *const inout_size);
+
+/**
+ * @brief Serialized payload of a rarely changing object, e.g. the response
+ * to uavcan.node.GetInfo, kept until the object is marked dirty.
+ *
+ * The storage is provided by the application.
+ */
+typedef struct
+{
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    const void *_source;
+    freecanard_cache_serialize _serialize;
+    uint8_t *_buffer;
+    size_t _capacity;
+    size_t _size;
+    uint32_t _generation;
+    uint32_t _cached_generation;
+    SemaphoreHandle_t _mutex;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    StaticSemaphore_t _mutex_buffer;
+#endif
+} freecanard_payload_cache_t;
+
+/**
+ * @brief Callback function executed whenever the transmission queue has been
+ * emptied, see @ref freecanard_set_tx_drained_callback.
+ *
+ * @note Executed by the task which handed the last frame to the driver, i.e.
+ * a task transmitting a transfer or polling the bus, without any Freecanard
+ * lock held.
+ */
+typedef void (*freecanard_on_tx_drained)(CanardInstance *ins);
+
 /**
  * @brief Everybody's favorite delicious cookie.
  * 
@@ -83,12 +756,135 @@ typedef struct
      * No not access from the application.
      */
     O1HeapInstance *_o1heap;
-    SemaphoreHandle_t _mutex;
+
+    /**
+     * Reception and transmission are performed on separate canard instances
+     * guarded by separate mutexes, so that neither direction ever waits for
+     * the other. The reception instance is the one provided by the
+     * application, and holds the subscriptions. Both share the memory pool,
+     * which is guarded by a short critical section.
+     */
+    SemaphoreHandle_t _rx_mutex;
+    SemaphoreHandle_t _tx_mutex;
+    CanardInstance _tx_ins;
+
+    /**
+     * Subscription changes waiting to be applied by the processing task,
+     * pushed without locking, see @ref freecanard_subscribe.
+     */
+    struct freecanard_rx_update *_rx_updates;
+    SemaphoreHandle_t _processing_wakeup;
+
+    /**
+     * Outstanding service calls, hashed by service, server and transfer-ID,
+     * guarded by a critical section.
+     */
+    freecanard_call_t *_calls[FREECANARD_CALL_TABLE_SIZE];
+    CanardTransferID _call_transfer_id;
+    UBaseType_t _calls_async_pending;
+
+#if FREECANARD_NUM_CORES > 1
+    QueueHandle_t _rx_core_queues[FREECANARD_NUM_CORES - 1];
+#endif
+    TaskHandle_t _processing_task;
+    bool _processing_task_notify;
+    UBaseType_t _processing_task_priority;
+    UBaseType_t _boost_priority;
+    UBaseType_t _boost_high_watermark;
+    UBaseType_t _boost_low_watermark;
+    uint8_t _boost_state;
+    uint32_t _boost_generation;
+    TickType_t _boost_start_tick;
+#if (configUSE_TIMERS == 1)
+    TimerHandle_t _rx_coalesce_timer;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    StaticTimer_t _rx_coalesce_timer_buffer;
+#endif
+    UBaseType_t _rx_coalesce_frames;
+    UBaseType_t _rx_coalesce_pending;
+#endif
+    QueueHandle_t _worker_queues[FREECANARD_MAX_WORKERS];
+    TaskHandle_t _worker_tasks[FREECANARD_MAX_WORKERS];
+    UBaseType_t _worker_count;
+
     QueueHandle_t _processing_task_queue;
     freecanard_platform_send _platform_send;
     freecanard_on_transfer_received _on_transfer_received;
+    freecanard_on_tx_drained _on_tx_drained;
+    const freecanard_port_filter_t *_rx_port_filter;
+    bool _loopback;
+    freecanard_stream_t *_streams;
+    freecanard_mailbox_t *_mailboxes;
+    freecanard_delivery_queue_t *_delivery_queues;
+    freecanard_buffer_provider_t *_rx_into_providers;
+    freecanard_buffer_provider_t *_rx_into_hint;
+    bool _rx_into_hint_skip_session;
+    size_t _rx_into_outstanding;
+    freecanard_rx_into_buffer_t _rx_into_buffers[FREECANARD_RX_INTO_MAX_BUFFERS];
+
+    uint8_t _rx_session_eviction_multiple;
+    TickType_t _rx_session_eviction_period;
+    TickType_t _rx_session_eviction_last_tick;
+    CanardMicrosecond _rx_last_timestamp_usec;
+    TickType_t _rx_last_tick;
+
+    size_t _tx_soft_watermark;
+    size_t _tx_hard_watermark;
+    CanardPriority _tx_soft_watermark_priority;
+
+    freecanard_payload_pool_t _rx_payload_pools[FREECANARD_RX_PAYLOAD_POOL_CLASSES];
+
+    freecanard_stats_t _stats;
 } freecanard_cookie_t;
 
+/**
+ * @brief Caller provided buffers for @ref freecanard_init_static.
+ *
+ * All buffers must remain valid for the lifetime of the instance, and are
+ * typically declared static.
+ */
+typedef struct
+{
+    /**
+     * Buffers holding the state of the reception and transmission mutexes.
+     */
+    StaticSemaphore_t *rx_mutex_buffer;
+    StaticSemaphore_t *tx_mutex_buffer;
+
+    /**
+     * Buffer holding the state of the processing task queue.
+     */
+    StaticQueue_t *processing_task_queue_buffer;
+
+    /**
+     * Storage area of the processing task queue. Must be at least
+     * FREECANARD_PROCESSING_TASK_QUEUE_STORAGE_SIZE(processing_task_queue_size)
+     * bytes long.
+     */
+    uint8_t *processing_task_queue_storage;
+
+    /**
+     * Buffer holding the TCB of the processing task. May be NULL, along with
+     * the stack, when no processing task is created.
+     */
+    StaticTask_t *processing_task_buffer;
+
+    /**
+     * Stack of the processing task. Must be at least
+     * processing_task_stack_size words long.
+     */
+    StackType_t *processing_task_stack;
+
+#if FREECANARD_NUM_CORES > 1
+    /**
+     * Buffers and storage areas of the ingestion queues of the cores other
+     * than the first one, sized as the processing task queue.
+     */
+    StaticQueue_t *rx_core_queue_buffers[FREECANARD_NUM_CORES - 1];
+    uint8_t *rx_core_queue_storage[FREECANARD_NUM_CORES - 1];
+#endif
+} freecanard_static_buffers_t;
+
 /**
  * @brief Initialize the Freecanard driver.
  * 
@@ -121,14 +917,26 @@ typedef struct
  * 
  * @param processing_task_queue_size Size of queue for incoming frames to
  * the processing task. If unsure, use FREECANARD_DEFAULT_PROCESSING_TASK_QUEUE_SIZE
+ *
+ * @param processing_task_stack_size Stack size of the processing task in
+ * words. If unsure, use FREECANARD_DEFAULT_PROCESSING_TASK_STACK_SIZE. Use
+ * FREECANARD_NO_PROCESSING_TASK to not create a processing task, in which
+ * case the bus must either be attached to a reactor, or be polled with
+ * @ref freecanard_poll.
  * 
  * @param platform_send Platform agnostic function that are used to send a frame over your 
  * interface of choice.
  * 
  * @param on_transfer_received Callback function which is called whenever a valid
  * full UAVCAN transfer is received. 
+ *
+ * @return true on success, false if a mutex, a queue or the processing task
+ * could not be created, or if the memory pool is too small to hold a heap,
+ * see FREECANARD_MIN_MEMORY_POOL_SIZE. Whatever was created is deleted again
+ * on failure.
  */
-void freecanard_init(
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_init(
     CanardInstance *const ins,
     freecanard_cookie_t *const cookie,
     const uint8_t canard_node_id,
@@ -136,9 +944,339 @@ void freecanard_init(
     uint8_t *memory_pool,
     const size_t memory_pool_size,
     const UBaseType_t processing_task_priority,
-    const UBaseType_t processing_task_size,
+    const UBaseType_t processing_task_queue_size,
+    const configSTACK_DEPTH_TYPE processing_task_stack_size,
     freecanard_platform_send platform_send,
     freecanard_on_transfer_received on_transfer_received);
+#endif
+
+/**
+ * @brief Initialize the Freecanard driver without using the FreeRTOS heap.
+ *
+ * Identical to @ref freecanard_init, except that the mutex, the processing
+ * task queue and the processing task are created from the caller provided
+ * @p buffers instead of being allocated from the FreeRTOS heap. Together with
+ * the memory pool, this allows all memory used by Freecanard to be sized and
+ * placed at link time.
+ *
+ * If any of the pointers are NULL, the behaviour is undefined.
+ *
+ * @param buffers Buffers for the FreeRTOS objects, sized according to
+ * @p processing_task_queue_size and @p processing_task_stack_size.
+ *
+ * @return true on success, false if a FreeRTOS object could not be created,
+ * e.g. as a buffer is NULL, or if the memory pool is too small to hold a
+ * heap, see FREECANARD_MIN_MEMORY_POOL_SIZE. Whatever was created is deleted
+ * again on failure.
+ */
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_init_static(
+    CanardInstance *const ins,
+    freecanard_cookie_t *const cookie,
+    const uint8_t canard_node_id,
+    const size_t mtu_bytes,
+    uint8_t *memory_pool,
+    const size_t memory_pool_size,
+    const UBaseType_t processing_task_priority,
+    const UBaseType_t processing_task_queue_size,
+    const configSTACK_DEPTH_TYPE processing_task_stack_size,
+    freecanard_platform_send platform_send,
+    freecanard_on_transfer_received on_transfer_received,
+    const freecanard_static_buffers_t *const buffers);
+#endif
+
+/**
+ * @brief Initialize the Freecanard driver inside a single memory arena.
+ *
+ * Carves everything needed by the bus out of @p arena, and initializes the
+ * driver as @ref freecanard_init_static would. The arena holds, in order:
+ * - the processing task queue state and its storage area, once per core,
+ * - the cookie, including the statistics,
+ * - the state of the mutexes,
+ * - the TCB and the stack of the processing task,
+ * - the memory pool, which takes the remainder of the arena. Libcanard
+ *   allocates both RX sessions and queued TX frames from the pool.
+ *
+ * Each region starts on its own cache line, so the frequently accessed queue
+ * state never shares a cache line with the rest. Placing the arena in a
+ * dedicated linker section, e.g. tightly coupled memory, therefore places the
+ * whole bus there.
+ *
+ * Use FREECANARD_ARENA_SIZE to size the arena.
+ *
+ * @param arena The arena. Must be aligned at FREECANARD_ARENA_ALIGNMENT.
+ *
+ * @param arena_size Size of the arena in bytes.
+ *
+ * See @ref freecanard_init for the remaining parameters.
+ *
+ * @return true on success, false if the arena is misaligned or too small to
+ * hold the resources and a memory pool of FREECANARD_MIN_MEMORY_POOL_SIZE
+ * bytes.
+ */
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_init_arena(
+    CanardInstance *const ins,
+    const uint8_t canard_node_id,
+    const size_t mtu_bytes,
+    uint8_t *arena,
+    const size_t arena_size,
+    const UBaseType_t processing_task_priority,
+    const UBaseType_t processing_task_queue_size,
+    const configSTACK_DEPTH_TYPE processing_task_stack_size,
+    freecanard_platform_send platform_send,
+    freecanard_on_transfer_received on_transfer_received);
+#endif
+
+/**
+ * @brief Reactor servicing several buses from a single task.
+ *
+ * By default every bus gets its own processing task, stack and queue. A
+ * reactor instead waits on the processing queues of all attached buses at
+ * once through a FreeRTOS queue set, and processes their frames on a single
+ * stack. Buses with frames waiting are serviced in a weighted round robin,
+ * see @ref freecanard_reactor_attach.
+ *
+ * @warning The application must only interact with the reactor through the
+ * public API.
+ */
+typedef struct
+{
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    QueueSetHandle_t _queue_set;
+    SemaphoreHandle_t _wakeup;
+    CanardInstance *_buses[FREECANARD_REACTOR_MAX_BUSES];
+    UBaseType_t _weights[FREECANARD_REACTOR_MAX_BUSES];
+    UBaseType_t _credits[FREECANARD_REACTOR_MAX_BUSES];
+    UBaseType_t _pending[FREECANARD_REACTOR_MAX_BUSES];
+    size_t _bus_count;
+    size_t _cursor;
+    TaskHandle_t _task;
+} freecanard_reactor_t;
+
+/**
+ * @brief Initialize a reactor, and create its task.
+ *
+ * @note Requires configUSE_QUEUE_SETS.
+ *
+ * @param reactor The reactor.
+ *
+ * @param task_priority Priority of the reactor task. Should at least be
+ * equal to the highest priority task depending on any of the attached buses.
+ *
+ * @param task_stack_size Stack size of the reactor task in words.
+ *
+ * @param queue_set_size Size of the queue set, which must be at least the
+ * sum of the processing task queue sizes of all buses to be attached, plus
+ * one for the reactor's own wake-up event.
+ *
+ * @return true on success, false if the queue set, its wake-up semaphore or
+ * the task could not be created. Whatever was created is deleted again on
+ * failure.
+ */
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1) && (configUSE_QUEUE_SETS == 1)
+bool freecanard_reactor_init(
+    freecanard_reactor_t *const reactor,
+    const UBaseType_t task_priority,
+    const configSTACK_DEPTH_TYPE task_stack_size,
+    const UBaseType_t queue_set_size);
+
+/**
+ * @brief Attach a bus to a reactor.
+ *
+ * The bus must have been initialized with FREECANARD_NO_PROCESSING_TASK, and
+ * its processing queue must be empty, i.e. no frame may have been enqueued
+ * yet.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param weight Number of frames of the bus processed in a row while other
+ * buses have frames waiting, >0. Equal weights service the buses in turn,
+ * one frame each, whatever their traffic.
+ *
+ * @return true on success, false if the reactor is full, the weight is 0 or
+ * the bus could not be attached.
+ */
+bool freecanard_reactor_attach(
+    freecanard_reactor_t *const reactor,
+    CanardInstance *const ins,
+    const UBaseType_t weight);
+#endif
+
+/**
+ * @brief Create a pool of worker tasks executing the transfer callback.
+ *
+ * By default the transfer callback is executed by the processing task, so a
+ * slow handler delays the reception of every frame on the bus. With a worker
+ * pool, the processing task only reassembles transfers, and hands every
+ * completed transfer to one of the workers. All transfers of a given port are
+ * handled by the same worker, so they are delivered in order.
+ *
+ * A transfer is dropped, and counted in @ref freecanard_stats_t, if the
+ * queue of its worker is full: the processing task never waits for a worker.
+ *
+ * @note Shall be called at most once per bus, right after initialization.
+ *
+ * @param ins Canard instance.
+ *
+ * @param worker_count Number of worker tasks, at most FREECANARD_MAX_WORKERS.
+ *
+ * @param worker_priority Priority of the worker tasks.
+ *
+ * @param worker_stack_size Stack size of each worker task in words.
+ *
+ * @param worker_queue_size Number of completed transfers each worker can hold
+ * before transfers are dropped.
+ *
+ * @return true on success, false if the pool could not be created. The
+ * workers created before the failure are deleted again, provided
+ * INCLUDE_vTaskDelete is enabled, so the call may be retried.
+ */
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_workers_init(
+    CanardInstance *const ins,
+    const UBaseType_t worker_count,
+    const UBaseType_t worker_priority,
+    const configSTACK_DEPTH_TYPE worker_stack_size,
+    const UBaseType_t worker_queue_size);
+#endif
+
+/**
+ * @brief Pin the tasks of the bus to a set of cores.
+ *
+ * On the FreeRTOS SMP kernel, keeping the processing task and the worker
+ * tasks on fixed cores avoids migrating their working set between the
+ * caches of different cores.
+ *
+ * @note Requires the FreeRTOS SMP kernel with configUSE_CORE_AFFINITY.
+ *
+ * @param ins Canard instance.
+ *
+ * @param processing_task_core_mask Cores the processing task, or the reactor
+ * task servicing the bus, may run on.
+ *
+ * @param worker_core_mask Cores the worker tasks may run on, if any.
+ *
+ * @return true on success, false if core affinity is not supported.
+ */
+bool freecanard_set_core_affinity(
+    CanardInstance *const ins,
+    const UBaseType_t processing_task_core_mask,
+    const UBaseType_t worker_core_mask);
+
+/**
+ * @brief Configure coalescing of processing task wake-ups.
+ *
+ * By default, the processing task is woken for every frame enqueued by
+ * @ref freecanard_process_received_frame_from_ISR, so a burst of multi-frame
+ * transfers costs a context switch per frame. With coalescing, the ISR only
+ * wakes the processing task once @p frame_threshold frames are pending, or
+ * @p max_latency_usec after the first pending frame was enqueued, whichever
+ * comes first. The latency is bounded by a one-shot software timer, and is
+ * rounded up to whole ticks.
+ *
+ * The processing queue must be able to hold at least @p frame_threshold
+ * frames. The processing task is woken right away should the queue fill up
+ * nevertheless.
+ *
+ * @note Frames enqueued from task context always wake the processing task
+ * right away. Buses serviced by a reactor are not supported.
+ *
+ * @note Requires configUSE_TIMERS. The timer is created on first use.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param frame_threshold Number of pending frames waking the processing
+ * task. 0 or 1 disables the coalescing, which is the default.
+ *
+ * @param max_latency_usec Maximum time a frame may be pending before the
+ * processing task is woken.
+ *
+ * @return true on success, false if the bus has no dedicated processing task
+ * or the timer could not be created.
+ */
+bool freecanard_set_rx_coalescing(
+    CanardInstance *const ins,
+    const UBaseType_t frame_threshold,
+    const uint32_t max_latency_usec);
+
+/**
+ * @brief Configure the adaptive priority boost of the processing task.
+ *
+ * The processing task runs at the priority given at initialization, and may
+ * be starved by higher priority tasks under bursts until its queue overflows.
+ * With the boost enabled, the processing task is temporarily raised to
+ * @p boost_priority as soon as @p high_watermark frames are waiting in its
+ * queue, and dropped back to its own priority once at most @p low_watermark
+ * frames are left after processing. Boosts are counted and timed in
+ * @ref freecanard_stats_t for tuning the watermarks.
+ *
+ * Boosts requested from an ISR are carried out by the timer service task,
+ * whose priority should therefore be at least @p boost_priority.
+ *
+ * @note Requires configUSE_TIMERS, INCLUDE_xTimerPendFunctionCall and
+ * INCLUDE_vTaskPrioritySet. Buses serviced by a reactor are not supported.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param high_watermark Number of waiting frames triggering a boost. 0
+ * disables the boost, which is the default.
+ *
+ * @param low_watermark Number of waiting frames at or below which the boost
+ * ends. Must be below @p high_watermark.
+ *
+ * @param boost_priority Priority of the processing task while boosted.
+ *
+ * @return true on success, false if the boost is not supported by the bus or
+ * the kernel configuration.
+ */
+bool freecanard_set_priority_boost(
+    CanardInstance *const ins,
+    const UBaseType_t high_watermark,
+    const UBaseType_t low_watermark,
+    const UBaseType_t boost_priority);
+
+/**
+ * @brief Process received frames and pending transmissions from the caller.
+ *
+ * Run-to-completion alternative to the processing task, for applications
+ * servicing the bus from their own loop. The bus must have been initialized
+ * with FREECANARD_NO_PROCESSING_TASK, and must not be attached to a reactor.
+ *
+ * Every call first hands the frames left in the TX queue, e.g. because the
+ * driver was busy, to the driver. Then it processes received frames as the
+ * processing task would, until the queue is empty, @p max_frames frames have
+ * been processed or @p budget_usec has elapsed, whichever comes first. The
+ * transfer callback, or the worker pool, is invoked exactly as in the task
+ * based mode. Finally, it runs the RX session eviction if it is due.
+ *
+ * @note The budget is measured with FREECANARD_MONOTONIC_USEC, so it is
+ * rounded to whole ticks unless a finer time base is provided. At least one
+ * frame is processed per call if any is waiting.
+ *
+ * @note This function shall be called from a single task.
+ *
+ * @warning This function shall not be called from an
+ * Interrupt Service Routine (ISR).
+ *
+ * @param ins Canard instance.
+ *
+ * @param max_frames Maximum number of received frames to process, SIZE_MAX
+ * for no limit.
+ *
+ * @param budget_usec Maximum time spent processing received frames,
+ * UINT32_MAX for no limit.
+ *
+ * @return Number of received frames processed.
+ */
+size_t freecanard_poll(CanardInstance *const ins, const size_t max_frames, const uint32_t budget_usec);
 
 /**
  * @brief Set canard node ID.
@@ -165,28 +1303,130 @@ void freecanard_set_user_reference(CanardInstance *const ins, void *user_referen
 /**
  * @brief Get canard node ID.
  */
-uint8_t freecanard_get_node_id(CanardInstance *const ins);
+uint8_t freecanard_get_node_id(CanardInstance *const ins);
+
+/**
+ * @brief Get canard MTU bytes.
+ */
+size_t freecanard_get_mtu_bytes(CanardInstance *const ins);
+
+/**
+ * @brief Get application specific user_reference stored within the cookie. 
+ * 
+ * @warning It is the application's responsibility to ensure proper guarding
+ * under concurrent access to the user_reference to avoid race conditions.
+ */
+void *freecanard_get_user_reference(CanardInstance *const ins);
+
+/**
+ * @brief Get a snapshot of the runtime statistics of the instance.
+ *
+ * @note This function is thread-safe and lock-free. Each counter is read
+ * atomically, but the snapshot as a whole is not.
+ */
+void freecanard_get_stats(CanardInstance *const ins, freecanard_stats_t *const out_stats);
+
+/**
+ * @brief Configure eviction of stale RX sessions.
+ *
+ * Libcanard allocates an RX session from the memory pool for every remote
+ * node transmitting on a subscribed port, and only releases it when the port
+ * is unsubscribed. On buses where nodes come and go, sessions belonging to
+ * nodes that have gone silent therefore slowly consume the memory pool.
+ *
+ * When enabled, the processing task periodically sweeps all subscriptions
+ * and releases every session that has not started a new transfer for longer
+ * than @p transfer_id_timeout_multiple times the transfer-ID timeout of its
+ * subscription. The number of released sessions and reclaimed bytes are
+ * accumulated in @ref freecanard_stats_t.
+ *
+ * @note A multi-frame transfer that lasts longer than the eviction age is
+ * aborted by the sweep, so the multiple should be well above 1. If unsure,
+ * use FREECANARD_DEFAULT_RX_SESSION_EVICTION_MULTIPLE.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param transfer_id_timeout_multiple Age of a stale session, expressed as a
+ * multiple of the transfer-ID timeout of its subscription. 0 disables the
+ * eviction, which is the default.
+ *
+ * @param sweep_period Time in ticks between two consecutive sweeps.
+ */
+void freecanard_set_rx_session_eviction(
+    CanardInstance *const ins,
+    const uint8_t transfer_id_timeout_multiple,
+    const TickType_t sweep_period);
 
 /**
- * @brief Get canard MTU bytes.
+ * @brief Immediately release all stale RX sessions.
+ *
+ * Performs the same sweep as the one periodically run by the processing task,
+ * see @ref freecanard_set_rx_session_eviction. Does nothing if the eviction
+ * is disabled.
+ *
+ * @note This function is thread-safe.
+ *
+ * @return Number of bytes returned to the memory pool.
  */
-size_t freecanard_get_mtu_bytes(CanardInstance *const ins);
+size_t freecanard_evict_stale_rx_sessions(CanardInstance *const ins);
 
 /**
- * @brief Get application specific user_reference stored within the cookie. 
- * 
- * @warning It is the application's responsibility to ensure proper guarding
- * under concurrent access to the user_reference to avoid race conditions.
+ * @brief Configure the memory pressure aware TX admission control.
+ *
+ * Transmitted transfers are queued in the memory pool until all of their
+ * frames have been handed to the driver. When the pool nears exhaustion,
+ * the admission control sheds the least important transfers first, so that
+ * critical publications keep flowing:
+ * - At or above the soft watermark, only transfers with a priority at or
+ *   above @p soft_watermark_priority are admitted.
+ * - At or above the hard watermark, only transfers with exceptional priority
+ *   are admitted.
+ *
+ * Both watermarks are expressed in bytes allocated from the memory pool, and
+ * are disabled by default.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param soft_watermark Soft watermark in bytes, SIZE_MAX to disable.
+ *
+ * @param soft_watermark_priority Lowest priority admitted above the soft
+ * watermark.
+ *
+ * @param hard_watermark Hard watermark in bytes, SIZE_MAX to disable.
  */
-void *freecanard_get_user_reference(CanardInstance *const ins);
+void freecanard_set_tx_admission(
+    CanardInstance *const ins,
+    const size_t soft_watermark,
+    const CanardPriority soft_watermark_priority,
+    const size_t hard_watermark);
 
 /**
  * @brief Create a new canard subscription.
  * 
  * See canardRxSubscribe in canard.h for more details.
+ *
+ * Payload buffers of completed transfers are recycled per extent rather than
+ * returned to the memory pool, for up to FREECANARD_RX_PAYLOAD_POOL_CLASSES
+ * distinct extents. This saves an allocation and a deallocation per received
+ * transfer on the hot reception path. Recycled buffers are returned to the
+ * memory pool whenever an allocation would otherwise fail.
+ *
+ * The subscription is not added while a frame is being processed. Instead,
+ * the change is handed to the task processing the bus without taking any
+ * lock, and applied by that task in between two frames, so reception is
+ * never stalled by reconfiguration. The function returns once the change is
+ * applied. Changes requested before the scheduler is started, from the
+ * processing task itself, e.g. from the transfer callback, or on a polled
+ * bus, are applied right away.
  * 
  * @note This function is thread-safe, and may be called concurrently
  * from several tasks.
+ *
+ * @note Requires INCLUDE_xTaskGetSchedulerState.
  * 
  * @warning This function shall not be called from an 
  * Interrupt Service Routine (ISR).
@@ -203,6 +1443,11 @@ int8_t freecanard_subscribe(
  * @brief Remove a canard subscription.
  * 
  * See canardRxUnsubscribe in canard.h for more details.
+ *
+ * As for @ref freecanard_subscribe, the change is applied by the task
+ * processing the bus in between two frames. Once the function returns, the
+ * processing task no longer refers to the subscription, which may therefore
+ * be reused or released by the application.
  * 
  * @note This function is thread-safe, and may be called concurrently
  * from several tasks.
@@ -215,6 +1460,273 @@ int8_t freecanard_unsubscribe(
     const CanardTransferKind transfer_kind,
     const CanardPortID port_id);
 
+/**
+ * @brief Add a canard subscription whose transfers are reassembled directly
+ * into buffers of the application.
+ *
+ * Identical to @ref freecanard_subscribe, except that the payload buffer of
+ * each transfer is requested from @p provider when the transfer starts,
+ * instead of being allocated from the memory pool. Libcanard writes the
+ * payload into it as frames arrive, and the transfer callback receives it
+ * as the payload of the transfer, saving the allocation and the copy out
+ * of the pool. The buffer is handed back to the provider once the callback
+ * returns, or if the transfer is dropped.
+ *
+ * At most FREECANARD_RX_INTO_MAX_BUFFERS provided buffers are held at once
+ * per bus, e.g. by transfers from several nodes in progress. Further
+ * transfers are reassembled into the memory pool.
+ *
+ * @note This function is thread-safe.
+ *
+ * @warning This function shall not be called from an
+ * Interrupt Service Routine (ISR).
+ *
+ * @param provider Provider of the payload buffers, NULL behaves as
+ * @ref freecanard_subscribe.
+ */
+int8_t freecanard_subscribe_into(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const size_t extent,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription,
+    freecanard_buffer_provider_t *const provider);
+
+/**
+ * @brief Add a streaming subscription.
+ *
+ * Transfers on the port are not reassembled by libcanard. Instead, the
+ * payload is handed to @p on_stream in chunks, in order, as frames arrive,
+ * followed by FREECANARD_STREAM_END once the CRC of the transfer is verified,
+ * or by FREECANARD_STREAM_ABORT. The memory used is that of @p stream, about
+ * a frame, whatever the size of the transfers, and nothing is allocated from
+ * the memory pool.
+ *
+ * A single transfer is received at a time. Frames of transfers from other
+ * nodes are dropped until the current transfer ends, or until a new transfer
+ * starts after @p transfer_id_timeout_usec.
+ *
+ * The last two bytes received are held back until the next frame, as they
+ * may be the CRC. Padding of the last frame is part of the payload, as with
+ * libcanard.
+ *
+ * The change is applied as with @ref freecanard_subscribe. A streaming
+ * subscription takes precedence over a regular subscription on the same
+ * port.
+ *
+ * @note This function is thread-safe.
+ *
+ * @warning This function shall not be called from an
+ * Interrupt Service Routine (ISR).
+ *
+ * @return 1 if the subscription was added, 0 if it replaced an existing
+ * streaming subscription on the port.
+ */
+int8_t freecanard_subscribe_stream(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    freecanard_stream_t *const stream,
+    freecanard_on_stream on_stream);
+
+/**
+ * @brief Remove a streaming subscription.
+ *
+ * A transfer in progress is dropped without notification.
+ *
+ * @note This function is thread-safe.
+ *
+ * @return 1 if the subscription was removed, 0 if there was none.
+ */
+int8_t freecanard_unsubscribe_stream(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id);
+
+/**
+ * @brief Add a canard subscription of which only the latest transfer is
+ * kept, in a mailbox read at the pace of the application.
+ *
+ * Identical to @ref freecanard_subscribe, except that received transfers
+ * are not passed to the transfer callback. The payload of each transfer is
+ * copied into @p mailbox instead, overwriting the previous one, e.g. for a
+ * 50 Hz display task reading a 1 kHz subject. Transfers published by the
+ * node itself with loopback enabled are sampled as well.
+ *
+ * The mailbox is removed by @ref freecanard_unsubscribe, or by subscribing
+ * to the port again. A mailbox subscribed again starts out empty, and shall
+ * not be read while the subscription is being replaced.
+ *
+ * @note This function is thread-safe.
+ *
+ * @warning This function shall not be called from an
+ * Interrupt Service Routine (ISR).
+ *
+ * @param mailbox Storage of the mailbox.
+ *
+ * @param buffer Storage of the payloads, of
+ * FREECANARD_MAILBOX_BUFFER_SIZE(extent) bytes.
+ */
+int8_t freecanard_subscribe_sampled(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const size_t extent,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription,
+    freecanard_mailbox_t *const mailbox,
+    uint8_t *const buffer);
+
+/**
+ * @brief Read the latest transfer of a sampled subscription.
+ *
+ * Wait-free. The returned transfer, payload included, remains valid and
+ * unchanged until the next read of the mailbox.
+ *
+ * @note A mailbox has a single reader. Reading it from several tasks at once
+ * requires external locking.
+ *
+ * @param out_fresh Set to whether the transfer was received since the
+ * previous read, may be NULL.
+ *
+ * @return The latest transfer, or NULL if none was received yet.
+ */
+const CanardTransfer *freecanard_mailbox_read(freecanard_mailbox_t *const mailbox, bool *const out_fresh);
+
+/**
+ * @brief Number of transfers written to a mailbox since it was subscribed.
+ *
+ * The difference between two reads accounts for the samples skipped by the
+ * reader.
+ *
+ * @note This function is thread-safe.
+ */
+uint32_t freecanard_mailbox_written(const freecanard_mailbox_t *const mailbox);
+
+/**
+ * @brief Initialize a delivery queue, and create its FreeRTOS queue.
+ *
+ * @param queue Storage of the delivery queue.
+ *
+ * @param extent Extent of the subscription the queue is used for.
+ *
+ * @param depth Maximum number of transfers waiting in the queue.
+ *
+ * @param policy What to drop when a transfer arrives and the queue is full.
+ *
+ * @return true on success, false if the queue could not be allocated.
+ */
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_delivery_queue_init(
+    freecanard_delivery_queue_t *const queue,
+    const size_t extent,
+    const UBaseType_t depth,
+    const freecanard_overflow_policy_t policy);
+#endif
+
+/**
+ * @brief Initialize a delivery queue without using the FreeRTOS heap.
+ *
+ * Identical to @ref freecanard_delivery_queue_init, except that the items and
+ * the staging buffer of the queue are placed in the caller provided
+ * @p storage, which must remain valid until the subscription is removed.
+ *
+ * @param storage Storage area of at least
+ * FREECANARD_DELIVERY_QUEUE_STORAGE_SIZE(extent, depth) bytes.
+ *
+ * @return true on success, false if the queue could not be created.
+ */
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_delivery_queue_init_static(
+    freecanard_delivery_queue_t *const queue,
+    const size_t extent,
+    const UBaseType_t depth,
+    const freecanard_overflow_policy_t policy,
+    uint8_t *const storage);
+#endif
+
+/**
+ * @brief Add a canard subscription whose transfers are queued for a
+ * consumer task.
+ *
+ * Identical to @ref freecanard_subscribe, with the extent of @p queue,
+ * except that received transfers are not passed to the transfer callback.
+ * Each transfer is copied into @p queue instead, to be drained by a task of
+ * the application at its own pace, e.g. for logging. The task processing
+ * the bus never waits for the consumer: when the queue is full, a transfer
+ * is dropped according to the policy of the queue, and counted. Transfers
+ * published by the node itself with loopback enabled are queued as well.
+ *
+ * The queue is detached by @ref freecanard_unsubscribe, or by subscribing
+ * to the port again. Transfers already queued may still be received.
+ *
+ * @note This function is thread-safe.
+ *
+ * @warning This function shall not be called from an
+ * Interrupt Service Routine (ISR).
+ *
+ * @param queue Delivery queue, initialized with
+ * @ref freecanard_delivery_queue_init or
+ * @ref freecanard_delivery_queue_init_static.
+ */
+int8_t freecanard_subscribe_queued(
+    CanardInstance *const ins,
+    const CanardTransferKind transfer_kind,
+    const CanardPortID port_id,
+    const CanardMicrosecond transfer_id_timeout_usec,
+    CanardRxSubscription *const out_subscription,
+    freecanard_delivery_queue_t *const queue);
+
+/**
+ * @brief Receive the oldest transfer of a delivery queue.
+ *
+ * @note A delivery queue may be drained by several tasks, as any FreeRTOS
+ * queue.
+ *
+ * @param out_transfer The transfer, whose payload points into @p buffer.
+ *
+ * @param buffer Buffer of FREECANARD_DELIVERY_ITEM_SIZE(extent) bytes,
+ * holding the payload until it is reused.
+ *
+ * @param timeout Time to wait for a transfer, in ticks.
+ *
+ * @return true if a transfer was received, false on timeout.
+ */
+bool freecanard_delivery_queue_receive(
+    freecanard_delivery_queue_t *const queue,
+    CanardTransfer *const out_transfer,
+    uint8_t *const buffer,
+    const TickType_t timeout);
+
+/**
+ * @brief Number of transfers dropped by a delivery queue, as it was full.
+ *
+ * @note This function is thread-safe.
+ */
+uint32_t freecanard_delivery_queue_drops(const freecanard_delivery_queue_t *const queue);
+
+/**
+ * @brief Set the ports accepted by the reception path.
+ *
+ * Frames of any other port are dropped by the task processing the bus before
+ * being fed to libcanard, without taking the reception lock. Meant for nodes
+ * whose subscriptions are all known at build time, with the filter kept in
+ * flash, see freecanard::DispatchTable in freecanard_dispatch.hpp.
+ *
+ * @note The filter shall cover every subscribed port, including the
+ * responses awaited by @ref freecanard_call. It is referred to, not copied,
+ * and shall remain valid until replaced.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param filter The filter, NULL to accept every frame.
+ */
+void freecanard_set_rx_port_filter(CanardInstance *const ins, const freecanard_port_filter_t *const filter);
+
 /**
  * @brief Transmit an UAVCAN transfer.
  * 
@@ -227,11 +1739,245 @@ int8_t freecanard_unsubscribe(
  * @param ins Canard instance
  * 
  * @param transfer Serialized UAVCAN transfer.
+ *
+ * @return >=0 Number of frames enqueued, see canardTxPush in canard.h.
+ *
+ * @return -FREECANARD_ERROR_TX_SOFT_WATERMARK or
+ * -FREECANARD_ERROR_TX_HARD_WATERMARK if the transfer was rejected by the
+ * admission control, see @ref freecanard_set_tx_admission.
+ *
+ * @return <0 Any other negated CANARD_ERROR_* code returned by canardTxPush.
+ */
+int32_t freecanard_transmit(
+    CanardInstance *const ins,
+    const CanardTransfer *const transfer);
+
+/**
+ * @brief Transmit an UAVCAN transfer to the bus only.
+ *
+ * Identical to @ref freecanard_transmit, except that the transfer is never
+ * delivered locally, e.g. for a publisher which has already handed the
+ * message to the local subscribers by other means.
  */
-void freecanard_transmit(
+int32_t freecanard_transmit_remote(
     CanardInstance *const ins,
     const CanardTransfer *const transfer);
 
+/**
+ * @brief Enable or disable the local delivery of published messages.
+ *
+ * With loopback enabled, a message transmitted with @ref freecanard_transmit
+ * on a subject the node subscribes to is also passed to the transfer
+ * callback right away, from the transmitting task, with the payload of the
+ * transmitted transfer. Local subscribers do not depend on the driver looping
+ * frames back through reception and reassembly, and the message is still
+ * sent to the bus for the remote subscribers. A message that is not queued
+ * for transmission, because it is invalid, shed by the TX admission control
+ * or out of memory, is not delivered locally either.
+ *
+ * @note The transfer callback may then be executed by any task transmitting
+ * messages, concurrently with the processing task, and shall be reentrant.
+ * It shall not transmit on a subject it subscribes to, as it would recurse.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param enable true to enable local delivery, disabled by default.
+ */
+void freecanard_set_loopback(CanardInstance *const ins, const bool enable);
+
+/**
+ * @brief Call a service and wait for its response.
+ *
+ * Sends a request to @p server_node_id, and blocks the calling task on a task
+ * notification until the matching response arrives or @p timeout elapses.
+ * Responses are matched on the service-ID, the server node-ID and the
+ * transfer-ID in constant time. Matched responses are consumed by the call,
+ * and are not passed to the transfer callback. Responses arriving after the
+ * call timed out are passed to the transfer callback as usual.
+ *
+ * The transfer-ID is allocated by Freecanard from a counter shared by all
+ * calls on the bus.
+ *
+ * @note The application must subscribe to the responses of the service, see
+ * @ref freecanard_subscribe with CanardTransferKindResponse.
+ *
+ * @note The calling task waits on the task notification with index
+ * FREECANARD_CALL_NOTIFICATION_INDEX.
+ *
+ * @note This function is thread-safe, and may be called concurrently
+ * from several tasks.
+ *
+ * @warning This function shall not be called from the transfer callback or
+ * an Interrupt Service Routine (ISR). On a polled bus, it shall not be called
+ * from the task calling @ref freecanard_poll.
+ *
+ * @param ins Canard instance.
+ *
+ * @param service_id Service-ID of the call.
+ *
+ * @param server_node_id Node-ID of the server.
+ *
+ * @param priority Priority of the request.
+ *
+ * @param request_payload Serialized request.
+ *
+ * @param request_payload_size Size of the serialized request in bytes.
+ *
+ * @param timeout Time in ticks to wait for the response.
+ *
+ * @param response Receives the response payload.
+ *
+ * @return 0 on success.
+ *
+ * @return -FREECANARD_ERROR_CALL_TIMEOUT if no response arrived in time.
+ *
+ * @return -FREECANARD_ERROR_CALL_BUSY if a call with the same transfer-ID is
+ * still outstanding on the same service and server.
+ *
+ * @return <0 Any other error returned by @ref freecanard_transmit.
+ */
+int32_t freecanard_call(
+    CanardInstance *const ins,
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardPriority priority,
+    const void *const request_payload,
+    const size_t request_payload_size,
+    const TickType_t timeout,
+    freecanard_response_t *const response);
+
+/**
+ * @brief Call a service without waiting for its response.
+ *
+ * Like @ref freecanard_call, except that the function returns once the
+ * request is enqueued, and @p on_response is executed by the processing task
+ * when the response arrives or @p timeout elapses.
+ *
+ * @note This function is thread-safe, and may be called from the transfer
+ * callback.
+ *
+ * @warning This function shall not be called from an Interrupt Service
+ * Routine (ISR).
+ *
+ * @param call Call record provided by the application, which must remain
+ * valid until @p on_response is executed.
+ *
+ * @param on_response Callback executed when the call completes.
+ *
+ * See @ref freecanard_call for the remaining parameters.
+ *
+ * @return 0 if the request was sent, in which case @p on_response is
+ * executed exactly once.
+ *
+ * @return -FREECANARD_ERROR_CALL_BUSY if a call with the same transfer-ID is
+ * still outstanding on the same service and server.
+ *
+ * @return <0 Any other error returned by @ref freecanard_transmit.
+ */
+int32_t freecanard_call_async(
+    CanardInstance *const ins,
+    const CanardPortID service_id,
+    const CanardNodeID server_node_id,
+    const CanardPriority priority,
+    const void *const request_payload,
+    const size_t request_payload_size,
+    const TickType_t timeout,
+    freecanard_call_t *const call,
+    freecanard_on_response on_response);
+
+/**
+ * @brief Initialize a payload cache.
+ *
+ * The source object is serialized lazily, by the first response following
+ * the initialization or a call to @ref freecanard_payload_cache_invalidate.
+ * Every other response enqueues the cached bytes as they are.
+ *
+ * @param cache The cache.
+ *
+ * @param source The object to serialize, which shall outlive the cache.
+ *
+ * @param serialize Callback serializing @p source.
+ *
+ * @param buffer Buffer holding the serialized object, e.g. of the
+ * SERIALIZATION_BUFFER_SIZE_BYTES_ of the type generated by Nunavut.
+ *
+ * @param buffer_size Size of the buffer in bytes.
+ *
+ * @return true on success, false if the mutex could not be created.
+ */
+bool freecanard_payload_cache_init(
+    freecanard_payload_cache_t *const cache,
+    const void *const source,
+    freecanard_cache_serialize serialize,
+    uint8_t *const buffer,
+    const size_t buffer_size);
+
+/**
+ * @brief Mark the source object of a payload cache dirty, so that it is
+ * serialized again by the next response.
+ *
+ * Shall be called after each modification of the source object. The source
+ * object shall not be modified while a response is being serialized, e.g. by
+ * modifying it from the task handling the requests only.
+ *
+ * @note This function is thread-safe, and may be called from an Interrupt
+ * Service Routine (ISR).
+ */
+void freecanard_payload_cache_invalidate(freecanard_payload_cache_t *const cache);
+
+/**
+ * @brief Respond to a request with the payload of a cache.
+ *
+ * The response mirrors the priority, service-ID, client node-ID and
+ * transfer-ID of the request. The source object is only serialized if it was
+ * marked dirty since the last response, otherwise answering is a single
+ * enqueue.
+ *
+ * @note This function is thread-safe, and may be called concurrently
+ * from several tasks, e.g. from the transfer callback.
+ *
+ * @param ins Canard instance.
+ *
+ * @param cache The cache.
+ *
+ * @param request The request to respond to.
+ *
+ * @return >=0 Result of @ref freecanard_transmit.
+ *
+ * @return <0 The error returned by the serialization callback, or by
+ * @ref freecanard_transmit.
+ */
+int32_t freecanard_respond_cached(
+    CanardInstance *const ins,
+    freecanard_payload_cache_t *const cache,
+    const CanardTransfer *const request);
+
+/**
+ * @brief Set the callback executed whenever the transmission queue has been
+ * emptied.
+ *
+ * Frames the driver could not accept right away stay in the transmission
+ * queue until a later transmission or @ref freecanard_poll retries them. The
+ * callback tells the application when all enqueued frames have been handed
+ * to the driver.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param ins Canard instance.
+ *
+ * @param on_tx_drained The callback, NULL to disable.
+ */
+void freecanard_set_tx_drained_callback(CanardInstance *const ins, freecanard_on_tx_drained on_tx_drained);
+
+/**
+ * @brief Check whether all enqueued frames have been handed to the driver.
+ *
+ * @note This function is thread-safe.
+ */
+bool freecanard_tx_queue_empty(CanardInstance *const ins);
+
 /**
  * @brief process received CAN(-FD) frame.
  * 
@@ -274,6 +2020,15 @@ void freecanard_process_received_frame(
  * Interrupt Service Routine (ISR).
  * 
  * @note This function may be called from an Interrupt Service Routine (ISR).
+ *
+ * @note Wake-ups of the processing task may be coalesced, see
+ * @ref freecanard_set_rx_coalescing.
+ *
+ * @note On the FreeRTOS SMP kernel, frames are enqueued into an ingestion
+ * queue dedicated to the core executing the ISR, so that interfaces whose
+ * interrupts are serviced by different cores do not contend on the same
+ * queue. The interrupt of a given interface must always be serviced by the
+ * same core to keep its frames in order.
  * 
  * @param ins Canard instance.
  * 
@@ -292,4 +2047,8 @@ void freecanard_process_received_frame_from_ISR(
     const CanardFrame *const frame,
     const uint8_t redundant_transport_index);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // FREECANARD_H
\ No newline at end of file
@@ -0,0 +1,634 @@
+#ifndef FREECANARD_HPP
+#define FREECANARD_HPP
+
+#if __cplusplus < 202002L
+#error "freecanard.hpp requires C++20"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+#include "freecanard.h"
+
+namespace freecanard
+{
+    /**
+     * @brief Fire-and-forget coroutine driving a protocol flow.
+     *
+     * The coroutine starts executing right away on the calling task, until it
+     * awaits one of the awaitables of @ref Node for the first time. It is then
+     * resumed by the task producing the awaited event, typically the
+     * processing task or a worker task, and its frame is released once it
+     * returns.
+     *
+     * Coroutine frames are allocated from the FreeRTOS heap. A flow whose
+     * frame cannot be allocated is not started.
+     *
+     * @code
+     * freecanard::Task blink_on_heartbeat(freecanard::Node &node)
+     * {
+     *     for (;;)
+     *     {
+     *         const CanardTransfer &transfer = co_await node.next_message(7509);
+     *         toggle_led(transfer.remote_node_id);
+     *     }
+     * }
+     * @endcode
+     */
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            Task get_return_object() noexcept { return {}; }
+            static Task get_return_object_on_allocation_failure() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+            static void *operator new(std::size_t size) noexcept { return pvPortMalloc(size); }
+            static void operator delete(void *pointer) noexcept { vPortFree(pointer); }
+#endif
+        };
+    };
+
+    /**
+     * @brief Outcome of an awaited service call, see @ref Node::call.
+     */
+    struct CallResult
+    {
+        /**
+         * 0 on success, otherwise the error returned by
+         * @ref freecanard_call_async or -FREECANARD_ERROR_CALL_TIMEOUT.
+         */
+        int32_t result;
+
+        /**
+         * The response on success, NULL otherwise. Valid until the coroutine
+         * suspends again.
+         */
+        const CanardTransfer *response;
+
+        explicit operator bool() const noexcept { return result == 0; }
+    };
+
+    /**
+     * @brief Coroutine front-end of a Freecanard bus.
+     *
+     * Dispatches received transfers to the coroutines awaiting them, and
+     * passes the remaining ones to a fallback callback. The bus must be
+     * initialized with @ref Node::on_transfer_received as its transfer
+     * callback.
+     *
+     * @note The node occupies the user_reference of the cookie, which is
+     * therefore no longer available to the application.
+     *
+     * @warning Awaitables refer to the node, which must outlive every
+     * coroutine awaiting on it.
+     */
+    class Node
+    {
+    public:
+        class NextTransfer;
+        class Call;
+        class TxDrained;
+
+        /**
+         * @brief Long-lived receiver of every transfer on a port.
+         *
+         * Executed on the task executing the transfer callback, before any
+         * coroutine awaiting the same port is resumed.
+         *
+         * A handler shall be detached, see @ref Node::detach, before it is
+         * destroyed. Handlers are never destroyed through a pointer to this
+         * class, hence its protected non-virtual destructor.
+         */
+        class Handler
+        {
+        public:
+            Handler(const Handler &) = delete;
+            Handler &operator=(const Handler &) = delete;
+
+        protected:
+            Handler(const CanardTransferKind kind, const CanardPortID port_id) noexcept
+                : kind_(kind), port_id_(port_id)
+            {
+            }
+            ~Handler() = default;
+
+            virtual void on_transfer(const CanardTransfer &transfer) noexcept = 0;
+
+            /**
+             * Receive a message published by the node itself, as the object
+             * it was serialized from, see @ref Node::deliver_local.
+             *
+             * @param type Opaque identifier of the type of @p object.
+             *
+             * @return true if the object was accepted.
+             */
+            virtual bool on_local(const void *type, const void *object, const CanardTransfer &transfer) noexcept
+            {
+                (void)type;
+                (void)object;
+                (void)transfer;
+                return false;
+            }
+
+            /**
+             * @return true if objects of @p type are currently accepted by
+             * @ref on_local, in which case the loopback of these objects'
+             * transfers is not passed to @ref on_transfer again.
+             */
+            virtual bool accepts_local(const void *type) const noexcept
+            {
+                (void)type;
+                return false;
+            }
+
+        private:
+            friend class Node;
+            Handler *next_ = nullptr;
+            CanardTransferKind kind_;
+            CanardPortID port_id_;
+        };
+
+        /**
+         * @param ins Initialized canard instance.
+         *
+         * @param fallback Callback receiving the transfers no coroutine is
+         * waiting for, may be NULL.
+         */
+        explicit Node(CanardInstance *ins, freecanard_on_transfer_received fallback = nullptr) noexcept
+            : ins_(ins), fallback_(fallback)
+        {
+            freecanard_set_user_reference(ins_, this);
+            freecanard_set_tx_drained_callback(ins_, &Node::on_tx_drained);
+        }
+
+        Node(const Node &) = delete;
+        Node &operator=(const Node &) = delete;
+
+        CanardInstance *instance() const noexcept { return ins_; }
+
+        /**
+         * Transfer callback to pass to @ref freecanard_init.
+         */
+        static void on_transfer_received(CanardInstance *ins, const CanardTransfer *const transfer) noexcept
+        {
+            Node *node = static_cast<Node *>(freecanard_get_user_reference(ins));
+            if (node != nullptr)
+            {
+                node->dispatch(transfer);
+            }
+        }
+
+        /**
+         * Start dispatching transfers to @p handler.
+         *
+         * @note Handlers are walked without locking, so they are meant to be
+         * attached once and live as long as the node. A handler may only be
+         * detached once its port is unsubscribed and the transfers already
+         * received on it have been handled.
+         */
+        void attach(Handler &handler) noexcept
+        {
+            taskENTER_CRITICAL();
+            handler.next_ = handlers_;
+            __atomic_store_n(&handlers_, &handler, __ATOMIC_RELEASE);
+            taskEXIT_CRITICAL();
+        }
+
+        void detach(Handler &handler) noexcept
+        {
+            taskENTER_CRITICAL();
+            for (Handler **link = &handlers_; *link != nullptr; link = &(*link)->next_)
+            {
+                if (*link == &handler)
+                {
+                    __atomic_store_n(link, handler.next_, __ATOMIC_RELEASE);
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * Hand a message published by the node itself to the handlers of its
+         * subject accepting objects of @p type, without serialization.
+         *
+         * @param transfer Metadata of the message, as transmitted.
+         *
+         * @return true if at least one handler accepted the object.
+         */
+        bool deliver_local(const void *type, const void *object, const CanardTransfer &transfer) noexcept
+        {
+            bool accepted = false;
+            for (Handler *handler = __atomic_load_n(&handlers_, __ATOMIC_ACQUIRE); handler != nullptr;
+                 handler = __atomic_load_n(&handler->next_, __ATOMIC_ACQUIRE))
+            {
+                if (handler->kind_ == CanardTransferKindMessage && handler->port_id_ == transfer.port_id)
+                {
+                    accepted = handler->on_local(type, object, transfer) || accepted;
+                }
+            }
+            return accepted;
+        }
+
+        /**
+         * Hand a message published by the node itself to the handlers
+         * accepting objects of @p type, see @ref deliver_local, then transmit
+         * it with @ref freecanard_transmit.
+         *
+         * When loopback is enabled, see @ref freecanard_set_loopback, the
+         * transmitted transfer is still dispatched to the coroutines, to the
+         * fallback callback and to the handlers which did not take the
+         * object, so that they do not miss the message.
+         *
+         * @return Result of @ref freecanard_transmit.
+         */
+        int32_t publish(const void *type, const void *object, const CanardTransfer &transfer) noexcept
+        {
+            CanardTransfer local = transfer;
+            local.remote_node_id = freecanard_get_node_id(ins_);
+            if (!deliver_local(type, object, local))
+            {
+                return freecanard_transmit(ins_, &transfer);
+            }
+
+            // The loopback is dispatched from within freecanard_transmit, on
+            // this task, so the record lives on the stack
+            LocalPublication publication{nullptr, type, transfer.payload};
+            taskENTER_CRITICAL();
+            publication.next = local_publications_;
+            local_publications_ = &publication;
+            taskEXIT_CRITICAL();
+
+            const int32_t res = freecanard_transmit(ins_, &transfer);
+
+            taskENTER_CRITICAL();
+            for (LocalPublication **link = &local_publications_; *link != nullptr; link = &(*link)->next)
+            {
+                if (*link == &publication)
+                {
+                    *link = publication.next;
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+            return res;
+        }
+
+        /**
+         * Await the next transfer of the given kind on the given port.
+         *
+         * The coroutine is resumed on the task executing the transfer
+         * callback, with the transfer, which is valid until the coroutine
+         * suspends again. The port must be subscribed to.
+         */
+        NextTransfer next_transfer(const CanardTransferKind kind, const CanardPortID port_id) noexcept;
+
+        /**
+         * Await the next message on the given subject.
+         */
+        NextTransfer next_message(const CanardPortID subject_id) noexcept;
+
+        /**
+         * Call a service, and await its response or timeout.
+         *
+         * The coroutine is resumed on the processing task. The request
+         * payload must remain valid until the awaitable is awaited. See
+         * @ref freecanard_call for the parameters.
+         */
+        Call call(
+            const CanardPortID service_id,
+            const CanardNodeID server_node_id,
+            const CanardPriority priority,
+            const void *const request_payload,
+            const size_t request_payload_size,
+            const TickType_t timeout) noexcept;
+
+        /**
+         * Await until every enqueued frame has been handed to the driver.
+         *
+         * Completes right away if the transmission queue is empty. Otherwise
+         * the coroutine is resumed on the task emptying the queue, see
+         * @ref freecanard_set_tx_drained_callback.
+         */
+        TxDrained tx_drained() noexcept;
+
+    private:
+        struct Waiter
+        {
+            Waiter *next;
+            CanardTransferKind kind;
+            CanardPortID port_id;
+            std::coroutine_handle<> handle;
+            const CanardTransfer *transfer;
+        };
+
+        struct LocalPublication
+        {
+            LocalPublication *next;
+            const void *type;
+            const void *payload;
+        };
+
+        static void on_tx_drained(CanardInstance *ins) noexcept
+        {
+            Node *node = static_cast<Node *>(freecanard_get_user_reference(ins));
+            if (node != nullptr)
+            {
+                node->resume_all(node->drained_waiters_, nullptr);
+            }
+        }
+
+        void push(Waiter *&list, Waiter *waiter) noexcept
+        {
+            taskENTER_CRITICAL();
+            waiter->next = list;
+            list = waiter;
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * @return true if the waiter was still in the list.
+         */
+        bool remove(Waiter *&list, Waiter *waiter) noexcept
+        {
+            bool removed = false;
+            taskENTER_CRITICAL();
+            for (Waiter **link = &list; *link != nullptr; link = &(*link)->next)
+            {
+                if (*link == waiter)
+                {
+                    *link = waiter->next;
+                    removed = true;
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+            return removed;
+        }
+
+        /**
+         * @return Type of the object a looped back transfer was published
+         * from, see @ref publish, or nullptr.
+         */
+        const void *local_publication_type(const CanardTransfer *const transfer) noexcept
+        {
+            const void *type = nullptr;
+            if (transfer->transfer_kind != CanardTransferKindMessage)
+            {
+                return type;
+            }
+            taskENTER_CRITICAL();
+            for (const LocalPublication *publication = local_publications_; publication != nullptr;
+                 publication = publication->next)
+            {
+                if (publication->payload == transfer->payload)
+                {
+                    type = publication->type;
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+            return type;
+        }
+
+        void dispatch(const CanardTransfer *const transfer) noexcept
+        {
+            // Handlers which took the published object already had it
+            const void *local_type = local_publication_type(transfer);
+
+            bool handled = false;
+            for (Handler *handler = __atomic_load_n(&handlers_, __ATOMIC_ACQUIRE); handler != nullptr;
+                 handler = __atomic_load_n(&handler->next_, __ATOMIC_ACQUIRE))
+            {
+                if (handler->kind_ == transfer->transfer_kind && handler->port_id_ == transfer->port_id)
+                {
+                    if (local_type == nullptr || !handler->accepts_local(local_type))
+                    {
+                        handler->on_transfer(*transfer);
+                    }
+                    handled = true;
+                }
+            }
+
+            // Detach the waiters first, so that a resumed coroutine awaiting
+            // the same port again waits for the next transfer
+            Waiter *matching = nullptr;
+            taskENTER_CRITICAL();
+            for (Waiter **link = &transfer_waiters_; *link != nullptr;)
+            {
+                Waiter *waiter = *link;
+                if (waiter->kind == transfer->transfer_kind && waiter->port_id == transfer->port_id)
+                {
+                    *link = waiter->next;
+                    waiter->next = matching;
+                    matching = waiter;
+                    continue;
+                }
+                link = &waiter->next;
+            }
+            taskEXIT_CRITICAL();
+
+            if (matching == nullptr)
+            {
+                if (!handled && fallback_ != nullptr)
+                {
+                    fallback_(ins_, transfer);
+                }
+                return;
+            }
+            resume_chain(matching, transfer);
+        }
+
+        void resume_all(Waiter *&list, const CanardTransfer *const transfer) noexcept
+        {
+            taskENTER_CRITICAL();
+            Waiter *waiters = list;
+            list = nullptr;
+            taskEXIT_CRITICAL();
+            resume_chain(waiters, transfer);
+        }
+
+        static void resume_chain(Waiter *waiters, const CanardTransfer *const transfer) noexcept
+        {
+            // A waiter lives in the frame of its coroutine, and is gone once
+            // the coroutine is resumed
+            while (waiters != nullptr)
+            {
+                Waiter *next = waiters->next;
+                waiters->transfer = transfer;
+                waiters->handle.resume();
+                waiters = next;
+            }
+        }
+
+        CanardInstance *ins_;
+        freecanard_on_transfer_received fallback_;
+        Handler *handlers_ = nullptr;
+        LocalPublication *local_publications_ = nullptr;
+        Waiter *transfer_waiters_ = nullptr;
+        Waiter *drained_waiters_ = nullptr;
+    };
+
+    class Node::NextTransfer
+    {
+    public:
+        NextTransfer(Node &node, const CanardTransferKind kind, const CanardPortID port_id) noexcept
+            : node_(node), waiter_{nullptr, kind, port_id, nullptr, nullptr}
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            waiter_.handle = handle;
+            node_.push(node_.transfer_waiters_, &waiter_);
+        }
+
+        const CanardTransfer &await_resume() const noexcept { return *waiter_.transfer; }
+
+    private:
+        Node &node_;
+        Waiter waiter_;
+    };
+
+    class Node::Call
+    {
+    public:
+        Call(Node &node,
+             const CanardPortID service_id,
+             const CanardNodeID server_node_id,
+             const CanardPriority priority,
+             const void *const request_payload,
+             const size_t request_payload_size,
+             const TickType_t timeout) noexcept
+            : node_(node),
+              service_id_(service_id),
+              server_node_id_(server_node_id),
+              priority_(priority),
+              request_payload_(request_payload),
+              request_payload_size_(request_payload_size),
+              timeout_(timeout)
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            handle_ = handle;
+            call_.user_reference_ = this;
+
+            // The response may resume the coroutine before the call returns,
+            // do not touch the awaiter afterwards unless the call failed
+            const int32_t res = freecanard_call_async(
+                node_.ins_,
+                service_id_,
+                server_node_id_,
+                priority_,
+                request_payload_,
+                request_payload_size_,
+                timeout_,
+                &call_,
+                &Call::on_response);
+            if (res < 0)
+            {
+                result_ = {res, nullptr};
+                return false;
+            }
+            return true;
+        }
+
+        CallResult await_resume() const noexcept { return result_; }
+
+    private:
+        static void on_response(CanardInstance *ins, freecanard_call_t *call, const CanardTransfer *const response)
+        {
+            (void)ins;
+            Call *self = static_cast<Call *>(call->user_reference_);
+            self->result_ = {response != nullptr ? 0 : -FREECANARD_ERROR_CALL_TIMEOUT, response};
+            self->handle_.resume();
+        }
+
+        Node &node_;
+        CanardPortID service_id_;
+        CanardNodeID server_node_id_;
+        CanardPriority priority_;
+        const void *request_payload_;
+        size_t request_payload_size_;
+        TickType_t timeout_;
+        freecanard_call_t call_{};
+        std::coroutine_handle<> handle_;
+        CallResult result_{};
+    };
+
+    class Node::TxDrained
+    {
+    public:
+        explicit TxDrained(Node &node) noexcept
+            : node_(node), waiter_{nullptr, CanardTransferKindMessage, 0, nullptr, nullptr}
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            // A concurrent drain may resume the coroutine as soon as the
+            // waiter is registered, so only locals are used afterwards
+            Node &node = node_;
+            Waiter *waiter = &waiter_;
+            waiter->handle = handle;
+            node.push(node.drained_waiters_, waiter);
+
+            // If the waiter is gone already, the drain resumes the coroutine
+            if (freecanard_tx_queue_empty(node.ins_))
+            {
+                return !node.remove(node.drained_waiters_, waiter);
+            }
+            return true;
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+        Node &node_;
+        Waiter waiter_;
+    };
+
+    inline Node::NextTransfer Node::next_transfer(const CanardTransferKind kind, const CanardPortID port_id) noexcept
+    {
+        return NextTransfer(*this, kind, port_id);
+    }
+
+    inline Node::NextTransfer Node::next_message(const CanardPortID subject_id) noexcept
+    {
+        return NextTransfer(*this, CanardTransferKindMessage, subject_id);
+    }
+
+    inline Node::Call Node::call(
+        const CanardPortID service_id,
+        const CanardNodeID server_node_id,
+        const CanardPriority priority,
+        const void *const request_payload,
+        const size_t request_payload_size,
+        const TickType_t timeout) noexcept
+    {
+        return Call(*this, service_id, server_node_id, priority, request_payload, request_payload_size, timeout);
+    }
+
+    inline Node::TxDrained Node::tx_drained() noexcept
+    {
+        return TxDrained(*this);
+    }
+} // namespace freecanard
+
+#endif // FREECANARD_HPP
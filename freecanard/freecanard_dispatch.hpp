@@ -0,0 +1,225 @@
+#ifndef FREECANARD_DISPATCH_HPP
+#define FREECANARD_DISPATCH_HPP
+
+#if __cplusplus < 202002L
+#error "freecanard_dispatch.hpp requires C++20"
+#endif
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "freecanard.h"
+
+namespace freecanard
+{
+    /**
+     * @brief Subscription known at build time, and the handler of its
+     * transfers, see @ref DispatchTable.
+     */
+    struct Route
+    {
+        CanardTransferKind transfer_kind;
+        CanardPortID port_id;
+        size_t extent;
+        freecanard_on_transfer_received handler;
+        CanardMicrosecond transfer_id_timeout_usec = CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC;
+    };
+
+    namespace detail
+    {
+        // Not constexpr on purpose: reaching them while building a dispatch
+        // table fails the compilation, naming the error.
+        inline void invalid_route() noexcept {}
+        inline void duplicate_route() noexcept {}
+    } // namespace detail
+
+    /**
+     * @brief Dispatch table of the subscriptions of a node, built at compile
+     * time.
+     *
+     * The table holds a bitmap of the routed ports of every transfer kind,
+     * along with the number of routes preceding each word of the bitmaps.
+     * Dispatching a transfer is then a bit test, a population count and an
+     * indirect call, whatever the number of routes. Declared constexpr, the
+     * table is placed in flash. The bitmaps double as the port filter of the
+     * reception path, see @ref freecanard_set_rx_port_filter, so frames of
+     * other ports never reach libcanard.
+     *
+     * Routes are validated at compile time: an out of range port, a missing
+     * handler or a port routed twice fails the compilation.
+     *
+     * @code
+     * static void on_heartbeat(CanardInstance *ins, const CanardTransfer *transfer);
+     * static void on_get_info(CanardInstance *ins, const CanardTransfer *transfer);
+     *
+     * static constexpr freecanard::Route routes[] = {
+     *     {CanardTransferKindMessage, 7509, 12, on_heartbeat},
+     *     {CanardTransferKindRequest, 430, 0, on_get_info},
+     * };
+     * static constexpr freecanard::DispatchTable table(routes);
+     * static CanardRxSubscription subscriptions[table.size()];
+     *
+     * freecanard_init(&ins, ..., freecanard::dispatch<table>, ...);
+     * table.subscribe(&ins, subscriptions);
+     * @endcode
+     */
+    template <std::size_t N>
+    class DispatchTable
+    {
+    public:
+        consteval explicit DispatchTable(const Route (&routes)[N]) noexcept
+        {
+            for (std::size_t i = 0; i < N; i++)
+            {
+                const Route &route = routes[i];
+                if (route.handler == nullptr || !valid_port(route.transfer_kind, route.port_id))
+                {
+                    detail::invalid_route();
+                }
+
+                // Insertion sort by transfer kind, then port-ID, so that the
+                // routes of a kind are stored in the order of their bits
+                std::size_t j = i;
+                while (j > 0 && key(route) < key(routes_[j - 1]))
+                {
+                    routes_[j] = routes_[j - 1];
+                    j--;
+                }
+                routes_[j] = route;
+            }
+
+            for (std::size_t i = 0; i < N; i++)
+            {
+                if (i > 0 && key(routes_[i]) == key(routes_[i - 1]))
+                {
+                    detail::duplicate_route();
+                }
+                const std::size_t word = word_index(routes_[i].transfer_kind, routes_[i].port_id);
+                bitmap_[word] |= 1UL << (routes_[i].port_id % 32U);
+            }
+
+            // Words of all kinds are laid out in the order of the routes
+            uint16_t rank = 0;
+            for (std::size_t word = 0; word < words; word++)
+            {
+                rank_[word] = rank;
+                rank = static_cast<uint16_t>(rank + std::popcount(bitmap_[word]));
+            }
+
+            filter_.ports[CanardTransferKindMessage] = &bitmap_[word_index(CanardTransferKindMessage, 0)];
+            filter_.ports[CanardTransferKindResponse] = &bitmap_[word_index(CanardTransferKindResponse, 0)];
+            filter_.ports[CanardTransferKindRequest] = &bitmap_[word_index(CanardTransferKindRequest, 0)];
+        }
+
+        DispatchTable(const DispatchTable &) = delete;
+        DispatchTable &operator=(const DispatchTable &) = delete;
+
+        static constexpr std::size_t size() noexcept { return N; }
+
+        /**
+         * Deliver a transfer to the handler of its route. Transfers of a port
+         * without route are ignored.
+         */
+        void dispatch(CanardInstance *const ins, const CanardTransfer *const transfer) const noexcept
+        {
+            const std::size_t word = word_index(transfer->transfer_kind, transfer->port_id);
+            const uint32_t bit = 1UL << (transfer->port_id % 32U);
+            if ((bitmap_[word] & bit) == 0U)
+            {
+                return;
+            }
+            routes_[rank_[word] + std::popcount(bitmap_[word] & (bit - 1U))].handler(ins, transfer);
+        }
+
+        /**
+         * Subscribe to the port of every route, then install the bitmaps of
+         * the table as port filter of the instance.
+         *
+         * @param subscriptions Subscriptions of the routes, in any order.
+         *
+         * @return 0 on success, otherwise the first error returned by
+         * @ref freecanard_subscribe.
+         */
+        int8_t subscribe(CanardInstance *const ins, CanardRxSubscription (&subscriptions)[N]) const noexcept
+        {
+            for (std::size_t i = 0; i < N; i++)
+            {
+                const int8_t res = freecanard_subscribe(
+                    ins,
+                    routes_[i].transfer_kind,
+                    routes_[i].port_id,
+                    routes_[i].extent,
+                    routes_[i].transfer_id_timeout_usec,
+                    &subscriptions[i]);
+                if (res < 0)
+                {
+                    return res;
+                }
+            }
+            freecanard_set_rx_port_filter(ins, &filter_);
+            return 0;
+        }
+
+        /**
+         * Port filter accepting exactly the routed ports.
+         */
+        constexpr const freecanard_port_filter_t &filter() const noexcept { return filter_; }
+
+    private:
+        static constexpr std::size_t words = FREECANARD_SUBJECT_FILTER_WORDS + 2U * FREECANARD_SERVICE_FILTER_WORDS;
+
+        static constexpr bool valid_port(const CanardTransferKind transfer_kind, const CanardPortID port_id) noexcept
+        {
+            switch (transfer_kind)
+            {
+            case CanardTransferKindMessage:
+                return port_id <= CANARD_SUBJECT_ID_MAX;
+            case CanardTransferKindResponse:
+            case CanardTransferKindRequest:
+                return port_id <= CANARD_SERVICE_ID_MAX;
+            default:
+                return false;
+            }
+        }
+
+        static constexpr uint32_t key(const Route &route) noexcept
+        {
+            return (static_cast<uint32_t>(route.transfer_kind) << 16U) | route.port_id;
+        }
+
+        static constexpr std::size_t word_index(const CanardTransferKind transfer_kind, const CanardPortID port_id) noexcept
+        {
+            std::size_t first_word = 0;
+            switch (transfer_kind)
+            {
+            case CanardTransferKindResponse:
+                first_word = FREECANARD_SUBJECT_FILTER_WORDS;
+                break;
+            case CanardTransferKindRequest:
+                first_word = FREECANARD_SUBJECT_FILTER_WORDS + FREECANARD_SERVICE_FILTER_WORDS;
+                break;
+            default:
+                break;
+            }
+            return first_word + port_id / 32U;
+        }
+
+        Route routes_[N]{};
+        uint32_t bitmap_[words]{};
+        uint16_t rank_[words]{};
+        freecanard_port_filter_t filter_{};
+    };
+
+    /**
+     * Transfer callback dispatching every received transfer through
+     * @p Table, to be passed to @ref freecanard_init.
+     */
+    template <const auto &Table>
+    void dispatch(CanardInstance *ins, const CanardTransfer *const transfer)
+    {
+        Table.dispatch(ins, transfer);
+    }
+} // namespace freecanard
+
+#endif // FREECANARD_DISPATCH_HPP
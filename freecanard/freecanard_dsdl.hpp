@@ -0,0 +1,541 @@
+#ifndef FREECANARD_DSDL_HPP
+#define FREECANARD_DSDL_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "freecanard.hpp"
+
+namespace freecanard
+{
+    /**
+     * @brief Compile-time description of a Nunavut generated DSDL type.
+     *
+     * Specialized for every type used with @ref Publisher and @ref Subscriber
+     * through FREECANARD_DEFINE_MESSAGE_TRAITS or
+     * FREECANARD_DEFINE_MESSAGE_TRAITS_WITH_PORT, which derive everything
+     * from the macros and functions generated by Nunavut.
+     */
+    template <typename T>
+    struct MessageTraits;
+
+    namespace detail
+    {
+        // Its address identifies T in local deliveries, without RTTI
+        template <typename T>
+        inline constexpr char type_tag = 0;
+    } // namespace detail
+} // namespace freecanard
+
+/**
+ * Define the traits of a Nunavut generated type with a fixed port-ID, e.g.
+ * FREECANARD_DEFINE_MESSAGE_TRAITS(uavcan_node_Heartbeat_1_0). Shall be used
+ * at global scope.
+ */
+#define FREECANARD_DEFINE_MESSAGE_TRAITS(T) FREECANARD_DEFINE_MESSAGE_TRAITS_WITH_PORT(T, T##_FIXED_PORT_ID_)
+
+/**
+ * Define the traits of a Nunavut generated type published on @p port.
+ * Shall be used at global scope.
+ */
+#define FREECANARD_DEFINE_MESSAGE_TRAITS_WITH_PORT(T, port)                                        \
+    template <>                                                                                    \
+    struct freecanard::MessageTraits<T>                                                            \
+    {                                                                                              \
+        static constexpr CanardPortID port_id = (port);                                            \
+        static constexpr size_t extent = T##_EXTENT_BYTES_;                                        \
+        static constexpr size_t buffer_size = T##_SERIALIZATION_BUFFER_SIZE_BYTES_;                \
+        static int8_t serialize(const T *const obj, uint8_t *const buffer, size_t *const size)     \
+        {                                                                                          \
+            return T##_serialize_(obj, buffer, size);                                              \
+        }                                                                                          \
+        static int8_t deserialize(T *const obj, const uint8_t *const buffer, size_t *const size)   \
+        {                                                                                          \
+            return T##_deserialize_(obj, buffer, size);                                            \
+        }                                                                                          \
+    }
+
+namespace freecanard
+{
+    /**
+     * @brief Publisher of messages of a DSDL type.
+     *
+     * The port-ID, and the size of the serialization buffer held by the
+     * publisher, are derived from the type at compile time. The publisher
+     * also keeps the transfer-ID of its subject.
+     *
+     * @code
+     * FREECANARD_DEFINE_MESSAGE_TRAITS(uavcan_node_Heartbeat_1_0);
+     *
+     * static freecanard::Publisher<uavcan_node_Heartbeat_1_0> heartbeat_publisher(&bus_0);
+     * heartbeat_publisher.publish(heartbeat);
+     * @endcode
+     *
+     * A publisher constructed on a @ref Node hands every message, by
+     * reference and before transmitting it, to the @ref Subscriber objects of
+     * the same type and subject on that node, which then never deserialize
+     * it. The message is still sent to the bus for the remote subscribers,
+     * and looped back at the transport level, see @ref freecanard_set_loopback,
+     * for the other local consumers, see @ref Node::publish.
+     *
+     * @warning A publisher is not thread-safe, as its buffer and transfer-ID
+     * are not guarded. Publish from a single task, or use one publisher per
+     * task.
+     */
+    template <typename T>
+    class Publisher
+    {
+    public:
+        using Traits = MessageTraits<T>;
+
+        explicit Publisher(
+            CanardInstance *ins,
+            const CanardPriority priority = CanardPriorityNominal,
+            const CanardPortID port_id = Traits::port_id) noexcept
+            : ins_(ins), priority_(priority), port_id_(port_id)
+        {
+        }
+
+        explicit Publisher(
+            Node &node,
+            const CanardPriority priority = CanardPriorityNominal,
+            const CanardPortID port_id = Traits::port_id) noexcept
+            : ins_(node.instance()), node_(&node), priority_(priority), port_id_(port_id)
+        {
+        }
+
+        Publisher(const Publisher &) = delete;
+        Publisher &operator=(const Publisher &) = delete;
+
+        /**
+         * Serialize and transmit a message.
+         *
+         * @return Result of the serialization if negative, otherwise the
+         * result of @ref freecanard_transmit.
+         */
+        int32_t publish(const T &message) noexcept
+        {
+            size_t size = sizeof(buffer_);
+            const int8_t res = Traits::serialize(&message, buffer_, &size);
+            if (res < 0)
+            {
+                return res;
+            }
+
+            const CanardTransfer transfer = {
+                FREECANARD_MONOTONIC_USEC(),
+                priority_,
+                CanardTransferKindMessage,
+                port_id_,
+                CANARD_NODE_ID_UNSET,
+                transfer_id_,
+                size,
+                buffer_,
+            };
+            transfer_id_ = static_cast<CanardTransferID>((transfer_id_ + 1U) & CANARD_TRANSFER_ID_MAX);
+
+            if (node_ != nullptr)
+            {
+                return node_->publish(&detail::type_tag<T>, &message, transfer);
+            }
+            return freecanard_transmit(ins_, &transfer);
+        }
+
+    private:
+        CanardInstance *ins_;
+        Node *node_ = nullptr;
+        CanardPriority priority_;
+        CanardPortID port_id_;
+        CanardTransferID transfer_id_ = 0;
+        uint8_t buffer_[Traits::buffer_size > 0 ? Traits::buffer_size : 1];
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Subscription to a port with the extent of a DSDL type,
+         * shared by @ref Subscriber and @ref TypedPort.
+         *
+         * The port is attached to its node on the first subscription, so
+         * that it receives the transfers of the port and the messages
+         * published locally. It is unsubscribed and detached when
+         * destroyed, so it may have automatic storage duration.
+         *
+         * @warning As for @ref Node::detach, a port shall only be destroyed
+         * once the transfers already received on it have been handled, and
+         * never from its own callbacks.
+         */
+        template <typename T>
+        class Port : private Node::Handler
+        {
+        public:
+            using Traits = MessageTraits<T>;
+
+            /**
+             * Subscribe to the port, and start delivering its transfers.
+             *
+             * @return Result of @ref freecanard_subscribe.
+             */
+            int8_t subscribe() noexcept
+            {
+                if (!attached_)
+                {
+                    node_.attach(*this);
+                    attached_ = true;
+                }
+                const int8_t res = freecanard_subscribe(
+                    node_.instance(),
+                    transfer_kind_,
+                    port_id_,
+                    Traits::extent,
+                    transfer_id_timeout_usec_,
+                    &subscription_);
+                if (res >= 0)
+                {
+                    __atomic_store_n(&subscribed_, true, __ATOMIC_RELAXED);
+                }
+                return res;
+            }
+
+            /**
+             * Unsubscribe from the port. Transfers already received may
+             * still be delivered when handled by a worker pool.
+             *
+             * @return Result of @ref freecanard_unsubscribe.
+             */
+            int8_t unsubscribe() noexcept
+            {
+                __atomic_store_n(&subscribed_, false, __ATOMIC_RELAXED);
+                return freecanard_unsubscribe(node_.instance(), transfer_kind_, port_id_);
+            }
+
+        protected:
+            Port(
+                Node &node,
+                const CanardTransferKind transfer_kind,
+                const CanardPortID port_id,
+                const CanardMicrosecond transfer_id_timeout_usec) noexcept
+                : Node::Handler(transfer_kind, port_id),
+                  node_(node),
+                  transfer_kind_(transfer_kind),
+                  port_id_(port_id),
+                  transfer_id_timeout_usec_(transfer_id_timeout_usec)
+            {
+            }
+            ~Port()
+            {
+                if (!attached_)
+                {
+                    return;
+                }
+                if (__atomic_load_n(&subscribed_, __ATOMIC_RELAXED))
+                {
+                    (void)unsubscribe();
+                }
+                node_.detach(*this);
+            }
+
+            /**
+             * @return true if a local message of type @p type is for this
+             * port, which only accepts them while subscribed.
+             */
+            bool accepts_local(const void *type) const noexcept override
+            {
+                return type == &type_tag<T> && __atomic_load_n(&subscribed_, __ATOMIC_RELAXED);
+            }
+
+        private:
+            Node &node_;
+            CanardTransferKind transfer_kind_;
+            CanardPortID port_id_;
+            CanardMicrosecond transfer_id_timeout_usec_;
+            CanardRxSubscription subscription_{};
+            bool attached_ = false;
+            bool subscribed_ = false;
+        };
+    } // namespace detail
+
+    /**
+     * @brief Subscriber to messages of a DSDL type.
+     *
+     * Subscribes with the extent of the type, and delivers every received
+     * message, deserialized, to a typed handler. Messages which fail to
+     * deserialize are dropped.
+     *
+     * @code
+     * static void on_heartbeat(const uavcan_node_Heartbeat_1_0 &heartbeat, const CanardTransfer &transfer, void *context);
+     *
+     * static freecanard::Subscriber<uavcan_node_Heartbeat_1_0> heartbeat_subscriber(node, on_heartbeat);
+     * heartbeat_subscriber.subscribe();
+     * @endcode
+     *
+     * @note The handler is executed on the task executing the transfer
+     * callback, and the message lives on its stack. Messages published on
+     * the same node by a @ref Publisher of the node are instead passed as
+     * is, on the publishing task.
+     */
+    template <typename T>
+    class Subscriber : public detail::Port<T>
+    {
+    public:
+        using Traits = MessageTraits<T>;
+        using Callback = void (*)(const T &message, const CanardTransfer &transfer, void *context);
+
+        Subscriber(
+            Node &node,
+            Callback callback,
+            void *context = nullptr,
+            const CanardPortID port_id = Traits::port_id,
+            const CanardMicrosecond transfer_id_timeout_usec = CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC) noexcept
+            : detail::Port<T>(node, CanardTransferKindMessage, port_id, transfer_id_timeout_usec),
+              callback_(callback),
+              context_(context)
+        {
+        }
+
+    private:
+        void on_transfer(const CanardTransfer &transfer) noexcept override
+        {
+            T message;
+            size_t size = transfer.payload_size;
+            if (Traits::deserialize(&message, static_cast<const uint8_t *>(transfer.payload), &size) >= 0)
+            {
+                callback_(message, transfer, context_);
+            }
+        }
+
+        bool on_local(const void *type, const void *object, const CanardTransfer &transfer) noexcept override
+        {
+            if (!this->accepts_local(type))
+            {
+                return false;
+            }
+            callback_(*static_cast<const T *>(object), transfer, context_);
+            return true;
+        }
+
+        Callback callback_;
+        void *context_;
+    };
+
+    /**
+     * @brief Pool of deserialized objects of a DSDL type, see @ref ObjectPool.
+     *
+     * Objects are taken and given back lock-free, through a bitmap of the
+     * objects in use, so the pool may be shared by the ports of a type
+     * handled by different worker tasks.
+     */
+    template <typename T>
+    class Pool
+    {
+    public:
+        Pool(const Pool &) = delete;
+        Pool &operator=(const Pool &) = delete;
+
+        /**
+         * @return A free object, or nullptr if all are in use.
+         */
+        T *acquire() noexcept
+        {
+            for (std::size_t word = 0; word < (capacity_ + 31U) / 32U; word++)
+            {
+                uint32_t used = __atomic_load_n(&used_[word], __ATOMIC_RELAXED);
+                for (;;)
+                {
+                    const std::size_t bit = static_cast<std::size_t>(std::countr_one(used));
+                    if (bit == 32U || word * 32U + bit >= capacity_)
+                    {
+                        break;
+                    }
+                    if (__atomic_compare_exchange_n(
+                            &used_[word], &used, used | (1UL << bit), true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                    {
+                        return &objects_[word * 32U + bit];
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        void release(T *const object) noexcept
+        {
+            const std::size_t index = static_cast<std::size_t>(object - objects_);
+            __atomic_fetch_and(&used_[index / 32U], ~(1UL << (index % 32U)), __ATOMIC_RELEASE);
+        }
+
+        std::size_t capacity() const noexcept { return capacity_; }
+
+    protected:
+        Pool(T *const objects, uint32_t *const used, const std::size_t capacity) noexcept
+            : objects_(objects), used_(used), capacity_(capacity)
+        {
+        }
+        ~Pool() = default;
+
+    private:
+        T *objects_;
+        uint32_t *used_;
+        std::size_t capacity_;
+    };
+
+    /**
+     * @brief Statically allocated pool of @p N objects of a DSDL type.
+     *
+     * Holds the objects of a type being handled at once, typically one per
+     * worker task handling ports of that type, see @ref TypedPort.
+     */
+    template <typename T, std::size_t N>
+    class ObjectPool : public Pool<T>
+    {
+        static_assert(N > 0, "An object pool holds at least one object");
+
+    public:
+        ObjectPool() noexcept : Pool<T>(objects_, used_, N) {}
+
+    private:
+        T objects_[N]{};
+        uint32_t used_[(N + 31U) / 32U]{};
+    };
+
+    /**
+     * @brief Port delivering deserialized objects of a DSDL type to any
+     * number of listeners.
+     *
+     * Every transfer is deserialized once, into an object drawn from a pool
+     * shared by the ports of the type, instead of once per handler into a
+     * stack object. The object is passed to every listener in turn, then
+     * given back to the pool. Transfers which fail to deserialize, or
+     * arriving while the pool is exhausted, are dropped and counted.
+     *
+     * @code
+     * FREECANARD_DEFINE_MESSAGE_TRAITS_WITH_PORT(uavcan_node_GetInfo_Response_1_0, uavcan_node_GetInfo_1_0_FIXED_PORT_ID_);
+     *
+     * static freecanard::ObjectPool<uavcan_node_GetInfo_Response_1_0, 1> get_info_pool;
+     * static freecanard::TypedPort<uavcan_node_GetInfo_Response_1_0> get_info_port(
+     *     node, get_info_pool, CanardTransferKindResponse);
+     * static freecanard::TypedPort<uavcan_node_GetInfo_Response_1_0>::Listener logger(on_get_info);
+     *
+     * get_info_port.listen(logger);
+     * get_info_port.subscribe();
+     * @endcode
+     *
+     * @note Listeners are executed on the task executing the transfer
+     * callback. The object is valid until the listener returns. Messages
+     * published on the same node by a @ref Publisher of the node are passed
+     * as is, on the publishing task.
+     */
+    template <typename T>
+    class TypedPort : public detail::Port<T>
+    {
+    public:
+        using Traits = MessageTraits<T>;
+        using Callback = void (*)(const T &object, const CanardTransfer &transfer, void *context);
+
+        /**
+         * @brief Receiver of the objects of a port, see @ref listen.
+         */
+        class Listener
+        {
+        public:
+            explicit Listener(Callback callback, void *context = nullptr) noexcept
+                : callback_(callback), context_(context)
+            {
+            }
+
+            Listener(const Listener &) = delete;
+            Listener &operator=(const Listener &) = delete;
+
+        private:
+            friend class TypedPort;
+            Listener *next_ = nullptr;
+            Callback callback_;
+            void *context_;
+        };
+
+        TypedPort(
+            Node &node,
+            Pool<T> &pool,
+            const CanardTransferKind transfer_kind = CanardTransferKindMessage,
+            const CanardPortID port_id = Traits::port_id,
+            const CanardMicrosecond transfer_id_timeout_usec = CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC) noexcept
+            : detail::Port<T>(node, transfer_kind, port_id, transfer_id_timeout_usec),
+              pool_(pool)
+        {
+        }
+
+        /**
+         * Start passing the objects of the port to @p listener.
+         *
+         * @note As for @ref Node::attach, listeners are meant to live as
+         * long as the port.
+         */
+        void listen(Listener &listener) noexcept
+        {
+            taskENTER_CRITICAL();
+            listener.next_ = listeners_;
+            __atomic_store_n(&listeners_, &listener, __ATOMIC_RELEASE);
+            taskEXIT_CRITICAL();
+        }
+
+        /**
+         * Number of transfers dropped, as they failed to deserialize or no
+         * object was left in the pool.
+         */
+        uint32_t dropped() const noexcept { return __atomic_load_n(&dropped_, __ATOMIC_RELAXED); }
+
+    private:
+        void on_transfer(const CanardTransfer &transfer) noexcept override
+        {
+            Listener *listeners = __atomic_load_n(&listeners_, __ATOMIC_ACQUIRE);
+            if (listeners == nullptr)
+            {
+                return;
+            }
+
+            T *object = pool_.acquire();
+            if (object == nullptr)
+            {
+                __atomic_fetch_add(&dropped_, 1U, __ATOMIC_RELAXED);
+                return;
+            }
+
+            size_t size = transfer.payload_size;
+            if (Traits::deserialize(object, static_cast<const uint8_t *>(transfer.payload), &size) >= 0)
+            {
+                notify(listeners, *object, transfer);
+            }
+            else
+            {
+                __atomic_fetch_add(&dropped_, 1U, __ATOMIC_RELAXED);
+            }
+            pool_.release(object);
+        }
+
+        bool on_local(const void *type, const void *object, const CanardTransfer &transfer) noexcept override
+        {
+            Listener *listeners = __atomic_load_n(&listeners_, __ATOMIC_ACQUIRE);
+            if (listeners == nullptr || !this->accepts_local(type))
+            {
+                return false;
+            }
+            notify(listeners, *static_cast<const T *>(object), transfer);
+            return true;
+        }
+
+        static void notify(Listener *listeners, const T &object, const CanardTransfer &transfer) noexcept
+        {
+            for (Listener *listener = listeners; listener != nullptr;
+                 listener = __atomic_load_n(&listener->next_, __ATOMIC_ACQUIRE))
+            {
+                listener->callback_(object, transfer, listener->context_);
+            }
+        }
+
+        Pool<T> &pool_;
+        Listener *listeners_ = nullptr;
+        uint32_t dropped_ = 0;
+    };
+} // namespace freecanard
+
+#endif // FREECANARD_DSDL_HPP
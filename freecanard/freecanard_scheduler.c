@@ -0,0 +1,385 @@
+#include "freecanard_scheduler.h"
+
+#include <string.h>
+
+#if (FREECANARD_SCHEDULER_WHEEL_SLOTS & (FREECANARD_SCHEDULER_WHEEL_SLOTS - 1U)) != 0
+#error "FREECANARD_SCHEDULER_WHEEL_SLOTS must be a power of two"
+#endif
+
+#define FREECANARD_SCHEDULER_SLOT(tick) ((size_t)((tick) & (FREECANARD_SCHEDULER_WHEEL_SLOTS - 1U)))
+
+static bool freecanard_scheduler_init_common(freecanard_scheduler_t *const scheduler);
+static void freecanard_scheduler_task(void *pvParameters);
+static void freecanard_scheduler_advance(freecanard_scheduler_t *const scheduler, const TickType_t now);
+static void freecanard_scheduler_release(
+    freecanard_scheduler_t *const scheduler,
+    freecanard_publication_t *const publication,
+    const TickType_t now);
+static void freecanard_scheduler_insert(freecanard_scheduler_t *const scheduler, freecanard_publication_t *const publication);
+static TickType_t freecanard_scheduler_next_delay(const freecanard_scheduler_t *const scheduler, const TickType_t now);
+static TickType_t freecanard_scheduler_auto_phase(
+    const freecanard_scheduler_t *const scheduler,
+    const TickType_t now,
+    const TickType_t period);
+static TickType_t freecanard_gcd(TickType_t a, TickType_t b);
+static bool freecanard_tick_reached(const TickType_t now, const TickType_t tick);
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_scheduler_init(
+    freecanard_scheduler_t *const scheduler,
+    const UBaseType_t task_priority,
+    const configSTACK_DEPTH_TYPE task_stack_size)
+{
+    if (!freecanard_scheduler_init_common(scheduler))
+    {
+        return false;
+    }
+
+    if (xTaskCreate(
+            freecanard_scheduler_task,
+            "FreecanardScheduler",
+            task_stack_size,
+            (void *)scheduler,
+            task_priority,
+            &scheduler->_task) != pdPASS)
+    {
+        vSemaphoreDelete(scheduler->_mutex);
+        scheduler->_mutex = NULL;
+        scheduler->_task = NULL;
+        return false;
+    }
+    return true;
+}
+#endif
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_scheduler_init_static(
+    freecanard_scheduler_t *const scheduler,
+    const UBaseType_t task_priority,
+    const configSTACK_DEPTH_TYPE task_stack_size,
+    StackType_t *const task_stack,
+    StaticTask_t *const task_buffer)
+{
+    if (!freecanard_scheduler_init_common(scheduler))
+    {
+        return false;
+    }
+
+    scheduler->_task = xTaskCreateStatic(
+        freecanard_scheduler_task,
+        "FreecanardScheduler",
+        task_stack_size,
+        (void *)scheduler,
+        task_priority,
+        task_stack,
+        task_buffer);
+    if (scheduler->_task == NULL)
+    {
+        vSemaphoreDelete(scheduler->_mutex);
+        scheduler->_mutex = NULL;
+        return false;
+    }
+    return true;
+}
+#endif
+
+/**
+ * Reset the wheel and create the mutex of a scheduler, from its own storage
+ * when static allocation is supported.
+ */
+static bool freecanard_scheduler_init_common(freecanard_scheduler_t *const scheduler)
+{
+    memset(scheduler->_slots, 0, sizeof(scheduler->_slots));
+    scheduler->_task = NULL;
+    scheduler->_cursor = xTaskGetTickCount();
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    scheduler->_mutex = xSemaphoreCreateMutexStatic(&scheduler->_mutex_buffer);
+#else
+    scheduler->_mutex = xSemaphoreCreateMutex();
+#endif
+    return scheduler->_mutex != NULL;
+}
+
+bool freecanard_scheduler_add(
+    freecanard_scheduler_t *const scheduler,
+    freecanard_publication_t *const publication,
+    CanardInstance *const ins,
+    const CanardPortID port_id,
+    const CanardPriority priority,
+    const TickType_t period,
+    const TickType_t phase,
+    freecanard_serialize serialize)
+{
+    if (period == 0 || (phase != FREECANARD_PHASE_AUTO && phase >= period))
+    {
+        return false;
+    }
+
+    publication->_ins = ins;
+    publication->_port_id = port_id;
+    publication->_priority = priority;
+    publication->_transfer_id = 0;
+    publication->_period = period;
+    publication->_serialize = serialize;
+    memset(&publication->_stats, 0, sizeof(publication->_stats));
+
+    xSemaphoreTake(scheduler->_mutex, portMAX_DELAY);
+
+    const TickType_t now = xTaskGetTickCount();
+    publication->_release = now + (phase == FREECANARD_PHASE_AUTO
+                                       ? freecanard_scheduler_auto_phase(scheduler, now, period)
+                                       : phase);
+    freecanard_scheduler_insert(scheduler, publication);
+
+    // The slot of a release due right away may already have been walked
+    if (!freecanard_tick_reached(publication->_release, scheduler->_cursor))
+    {
+        scheduler->_cursor = publication->_release;
+    }
+
+    xSemaphoreGive(scheduler->_mutex);
+
+    // Let the scheduler task reconsider how long to sleep
+    if (scheduler->_task != NULL)
+    {
+        xTaskNotifyGive(scheduler->_task);
+    }
+    return true;
+}
+
+void freecanard_scheduler_remove(freecanard_scheduler_t *const scheduler, freecanard_publication_t *const publication)
+{
+    xSemaphoreTake(scheduler->_mutex, portMAX_DELAY);
+
+    freecanard_publication_t **link = &scheduler->_slots[FREECANARD_SCHEDULER_SLOT(publication->_release)];
+    while (*link != NULL && *link != publication)
+    {
+        link = &(*link)->_next;
+    }
+    if (*link != NULL)
+    {
+        *link = publication->_next;
+        publication->_next = NULL;
+    }
+
+    xSemaphoreGive(scheduler->_mutex);
+}
+
+void freecanard_scheduler_get_stats(
+    freecanard_scheduler_t *const scheduler,
+    const freecanard_publication_t *const publication,
+    freecanard_publication_stats_t *const out_stats)
+{
+    xSemaphoreTake(scheduler->_mutex, portMAX_DELAY);
+    *out_stats = publication->_stats;
+    xSemaphoreGive(scheduler->_mutex);
+}
+
+/**
+ * The scheduler task. Releases the due publications, then sleeps until the
+ * next occupied slot of the wheel, or until a publication is added.
+ */
+static void freecanard_scheduler_task(void *pvParameters)
+{
+    freecanard_scheduler_t *scheduler = (freecanard_scheduler_t *)pvParameters;
+
+    for (;;)
+    {
+        xSemaphoreTake(scheduler->_mutex, portMAX_DELAY);
+        const TickType_t now = xTaskGetTickCount();
+        freecanard_scheduler_advance(scheduler, now);
+        const TickType_t delay = freecanard_scheduler_next_delay(scheduler, now);
+        xSemaphoreGive(scheduler->_mutex);
+
+        (void)ulTaskNotifyTake(pdTRUE, delay);
+    }
+}
+
+/**
+ * Walk the slots of the wheel from the cursor up to @p now, and release the
+ * publications which are due. Publications hashed onto a walked slot for a
+ * later turn of the wheel are left in place.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_scheduler_advance(freecanard_scheduler_t *const scheduler, const TickType_t now)
+{
+    if (!freecanard_tick_reached(now, scheduler->_cursor))
+    {
+        return;
+    }
+
+    TickType_t slot_count = now - scheduler->_cursor + 1U;
+    if (slot_count > FREECANARD_SCHEDULER_WHEEL_SLOTS)
+    {
+        slot_count = FREECANARD_SCHEDULER_WHEEL_SLOTS;
+    }
+
+    for (TickType_t i = 0; i < slot_count; i++)
+    {
+        const size_t slot = FREECANARD_SCHEDULER_SLOT(scheduler->_cursor + i);
+
+        // Detach the slot, as releases are reinserted at their next tick
+        freecanard_publication_t *publication = scheduler->_slots[slot];
+        scheduler->_slots[slot] = NULL;
+        while (publication != NULL)
+        {
+            freecanard_publication_t *next = publication->_next;
+            if (freecanard_tick_reached(now, publication->_release))
+            {
+                freecanard_scheduler_release(scheduler, publication, now);
+            }
+            freecanard_scheduler_insert(scheduler, publication);
+            publication = next;
+        }
+    }
+
+    scheduler->_cursor = now + 1U;
+}
+
+/**
+ * Serialize and transmit a due publication, account for its timing, and
+ * move its release to the next period.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_scheduler_release(
+    freecanard_scheduler_t *const scheduler,
+    freecanard_publication_t *const publication,
+    const TickType_t now)
+{
+    freecanard_publication_stats_t *stats = &publication->_stats;
+
+    // Releases missed entirely are skipped rather than published in a burst
+    const TickType_t missed = (TickType_t)(now - publication->_release) / publication->_period;
+    publication->_release += missed * publication->_period;
+    stats->skipped += (uint32_t)missed;
+
+    const TickType_t jitter = now - publication->_release;
+    stats->jitter_last = jitter;
+    stats->jitter_total += (uint32_t)jitter;
+    if (jitter > stats->jitter_max)
+    {
+        stats->jitter_max = jitter;
+    }
+
+    publication->_release += publication->_period;
+
+    size_t size = sizeof(scheduler->_buffer);
+    if (publication->_serialize(publication, scheduler->_buffer, &size) < 0)
+    {
+        stats->failed++;
+        return;
+    }
+
+    const CanardTransfer transfer = {
+        .timestamp_usec = FREECANARD_MONOTONIC_USEC(),
+        .priority = publication->_priority,
+        .transfer_kind = CanardTransferKindMessage,
+        .port_id = publication->_port_id,
+        .remote_node_id = CANARD_NODE_ID_UNSET,
+        .transfer_id = publication->_transfer_id,
+        .payload_size = size,
+        .payload = scheduler->_buffer};
+    publication->_transfer_id = (CanardTransferID)((publication->_transfer_id + 1U) & CANARD_TRANSFER_ID_MAX);
+
+    if (freecanard_transmit(publication->_ins, &transfer) < 0)
+    {
+        stats->failed++;
+        return;
+    }
+    stats->published++;
+}
+
+/**
+ * Note: This function is NOT thread safe.
+ */
+static void freecanard_scheduler_insert(freecanard_scheduler_t *const scheduler, freecanard_publication_t *const publication)
+{
+    const size_t slot = FREECANARD_SCHEDULER_SLOT(publication->_release);
+    publication->_next = scheduler->_slots[slot];
+    scheduler->_slots[slot] = publication;
+}
+
+/**
+ * Number of ticks until the next occupied slot, at most a turn of the wheel.
+ *
+ * Note: This function is NOT thread safe.
+ */
+static TickType_t freecanard_scheduler_next_delay(const freecanard_scheduler_t *const scheduler, const TickType_t now)
+{
+    for (TickType_t delay = 1; delay < FREECANARD_SCHEDULER_WHEEL_SLOTS; delay++)
+    {
+        if (scheduler->_slots[FREECANARD_SCHEDULER_SLOT(now + delay)] != NULL)
+        {
+            return delay;
+        }
+    }
+    return FREECANARD_SCHEDULER_WHEEL_SLOTS;
+}
+
+/**
+ * Pick the phase, within the first period or turn of the wheel, at which the
+ * fewest publications will ever be released on the same tick. Publications of
+ * periods P and Q released at ticks a and b collide eventually if and only if
+ * a - b is a multiple of gcd(P, Q).
+ *
+ * Note: This function is NOT thread safe.
+ */
+static TickType_t freecanard_scheduler_auto_phase(
+    const freecanard_scheduler_t *const scheduler,
+    const TickType_t now,
+    const TickType_t period)
+{
+    const TickType_t candidates = period < FREECANARD_SCHEDULER_WHEEL_SLOTS ? period : FREECANARD_SCHEDULER_WHEEL_SLOTS;
+
+    TickType_t best_phase = 0;
+    size_t best_load = SIZE_MAX;
+    for (TickType_t phase = 0; phase < candidates && best_load > 0; phase++)
+    {
+        const TickType_t release = now + phase;
+        size_t load = 0;
+        for (size_t slot = 0; slot < FREECANARD_SCHEDULER_WHEEL_SLOTS; slot++)
+        {
+            for (const freecanard_publication_t *publication = scheduler->_slots[slot];
+                 publication != NULL;
+                 publication = publication->_next)
+            {
+                const TickType_t distance = freecanard_tick_reached(release, publication->_release)
+                                                ? release - publication->_release
+                                                : publication->_release - release;
+                if (distance % freecanard_gcd(period, publication->_period) == 0)
+                {
+                    load++;
+                }
+            }
+        }
+
+        if (load < best_load)
+        {
+            best_load = load;
+            best_phase = phase;
+        }
+    }
+    return best_phase;
+}
+
+static TickType_t freecanard_gcd(TickType_t a, TickType_t b)
+{
+    while (b != 0)
+    {
+        const TickType_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+/**
+ * Check whether @p tick is not later than @p now, accounting for the tick
+ * counter wrapping around.
+ */
+static bool freecanard_tick_reached(const TickType_t now, const TickType_t tick)
+{
+    return (TickType_t)(now - tick) < (portMAX_DELAY / 2U);
+}
@@ -0,0 +1,244 @@
+#ifndef FREECANARD_SCHEDULER_H
+#define FREECANARD_SCHEDULER_H
+
+#include "freecanard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Number of slots of the timer wheel, a power of two. Publications are
+ * hashed onto the slots by their release tick, and the scheduler task sleeps
+ * at most this many ticks at once.
+ */
+#ifndef FREECANARD_SCHEDULER_WHEEL_SLOTS
+#define FREECANARD_SCHEDULER_WHEEL_SLOTS 64U
+#endif
+
+/**
+ * Size in bytes of the serialization buffer shared by all publications of a
+ * scheduler, i.e. the largest serialized message it can publish.
+ */
+#ifndef FREECANARD_SCHEDULER_BUFFER_SIZE
+#define FREECANARD_SCHEDULER_BUFFER_SIZE 256U
+#endif
+
+/**
+ * Phase requesting the scheduler to pick the phase of a publication itself,
+ * see @ref freecanard_scheduler_add.
+ */
+#define FREECANARD_PHASE_AUTO portMAX_DELAY
+
+/**
+ * @brief Timing statistics of a periodic publication.
+ *
+ * The jitter is the delay in ticks between the nominal release of a
+ * publication and its transmission.
+ */
+typedef struct
+{
+    /**
+     * Number of messages handed to @ref freecanard_transmit successfully.
+     */
+    uint32_t published;
+
+    /**
+     * Number of releases which failed to serialize or to transmit.
+     */
+    uint32_t failed;
+
+    /**
+     * Number of releases skipped, as the scheduler was late by more than a
+     * period.
+     */
+    uint32_t skipped;
+
+    /**
+     * Jitter of the last release, the largest jitter, and the sum of the
+     * jitter of all releases, e.g. to compute the mean.
+     */
+    TickType_t jitter_last;
+    TickType_t jitter_max;
+    uint32_t jitter_total;
+} freecanard_publication_stats_t;
+
+typedef struct freecanard_publication freecanard_publication_t;
+
+/**
+ * @brief Callback function serializing the next message of a periodic
+ * publication.
+ *
+ * @note Executed by the scheduler task, with the scheduler locked. It shall
+ * not add or remove publications.
+ *
+ * @param publication The publication being released.
+ *
+ * @param buffer Buffer of FREECANARD_SCHEDULER_BUFFER_SIZE bytes.
+ *
+ * @param inout_size Size of the buffer on entry, size of the serialized
+ * message on return.
+ *
+ * @return 0 on success, <0 to skip the release.
+ */
+typedef int8_t (*freecanard_serialize)(
+    freecanard_publication_t *publication,
+    uint8_t *const buffer,
+    size_t *const inout_size);
+
+/**
+ * @brief Periodic publication of a subject, see @ref freecanard_scheduler_add.
+ *
+ * The storage is provided by the application, and shall remain valid until
+ * the publication is removed.
+ */
+struct freecanard_publication
+{
+    /**
+     * User defined reference, e.g. to the data to be published.
+     * Not used by Freecanard.
+     */
+    void *user_reference_;
+
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    freecanard_publication_t *_next;
+    CanardInstance *_ins;
+    CanardPortID _port_id;
+    CanardPriority _priority;
+    CanardTransferID _transfer_id;
+    TickType_t _period;
+    TickType_t _release;
+    freecanard_serialize _serialize;
+    freecanard_publication_stats_t _stats;
+};
+
+/**
+ * @brief Publication scheduler.
+ *
+ * Releases any number of periodic publications from a single task, driven by
+ * a hashed timer wheel, instead of a task, a stack and a serialization buffer
+ * per publication. The storage is provided by the application.
+ */
+typedef struct
+{
+    /**
+     * These fields are for internal use only.
+     * Do not access from the application.
+     */
+    freecanard_publication_t *_slots[FREECANARD_SCHEDULER_WHEEL_SLOTS];
+    SemaphoreHandle_t _mutex;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    StaticSemaphore_t _mutex_buffer;
+#endif
+    TaskHandle_t _task;
+    TickType_t _cursor;
+    uint8_t _buffer[FREECANARD_SCHEDULER_BUFFER_SIZE];
+} freecanard_scheduler_t;
+
+/**
+ * @brief Initialize a publication scheduler, and create its task.
+ *
+ * @param scheduler The scheduler.
+ *
+ * @param task_priority Priority of the scheduler task, which serializes and
+ * transmits all publications.
+ *
+ * @param task_stack_size Stack size of the scheduler task in words. Shall
+ * accommodate the deepest serialization callback.
+ *
+ * @return true on success, false if the mutex or the task could not be
+ * created.
+ */
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+bool freecanard_scheduler_init(
+    freecanard_scheduler_t *const scheduler,
+    const UBaseType_t task_priority,
+    const configSTACK_DEPTH_TYPE task_stack_size);
+#endif
+
+/**
+ * @brief Initialize a publication scheduler without using the FreeRTOS heap.
+ *
+ * Identical to @ref freecanard_scheduler_init, except that the scheduler task
+ * is created from the caller provided @p task_stack and @p task_buffer, which
+ * must remain valid for the lifetime of the scheduler.
+ *
+ * @param task_stack Stack of the scheduler task, at least
+ * @p task_stack_size words long.
+ *
+ * @param task_buffer Buffer holding the TCB of the scheduler task.
+ *
+ * @return true on success, false if the task could not be created.
+ */
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+bool freecanard_scheduler_init_static(
+    freecanard_scheduler_t *const scheduler,
+    const UBaseType_t task_priority,
+    const configSTACK_DEPTH_TYPE task_stack_size,
+    StackType_t *const task_stack,
+    StaticTask_t *const task_buffer);
+#endif
+
+/**
+ * @brief Add a periodic publication to a scheduler.
+ *
+ * The first release happens @p phase ticks after the call, then every
+ * @p period ticks. With FREECANARD_PHASE_AUTO, the scheduler picks the phase
+ * at which the fewest publications already added will ever be released on the
+ * same tick, so that publications are staggered rather than released in a
+ * burst.
+ *
+ * @note This function is thread-safe.
+ *
+ * @param publication Storage of the publication.
+ *
+ * @param ins Canard instance to publish on.
+ *
+ * @param period Period in ticks, >0.
+ *
+ * @param phase Delay of the first release in ticks, <period, or
+ * FREECANARD_PHASE_AUTO.
+ *
+ * @param serialize Callback serializing a message.
+ *
+ * @return true on success, false if the period or phase is invalid.
+ */
+bool freecanard_scheduler_add(
+    freecanard_scheduler_t *const scheduler,
+    freecanard_publication_t *const publication,
+    CanardInstance *const ins,
+    const CanardPortID port_id,
+    const CanardPriority priority,
+    const TickType_t period,
+    const TickType_t phase,
+    freecanard_serialize serialize);
+
+/**
+ * @brief Remove a publication from a scheduler.
+ *
+ * Once the function returns, the publication is no longer referred to by the
+ * scheduler, and its storage may be reused.
+ *
+ * @note This function is thread-safe.
+ */
+void freecanard_scheduler_remove(freecanard_scheduler_t *const scheduler, freecanard_publication_t *const publication);
+
+/**
+ * @brief Copy the timing statistics of a publication.
+ *
+ * @note This function is thread-safe.
+ */
+void freecanard_scheduler_get_stats(
+    freecanard_scheduler_t *const scheduler,
+    const freecanard_publication_t *const publication,
+    freecanard_publication_stats_t *const out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FREECANARD_SCHEDULER_H